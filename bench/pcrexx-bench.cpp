@@ -0,0 +1,295 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Measures the main paths through the wrapper: compiling, scanning a corpus
+// for matches (allocation-free views) and extracting groups, with and
+// without study/JIT.  Usage: pcrexx-bench [megabytes-per-corpus].
+
+#include "pcre.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Count all heap allocations, including PCRE's own.
+    std::size_t allocations = 0;
+
+    void * counted_malloc ( std::size_t size )
+    {
+        ++allocations;
+        return (std::malloc(size));
+    }
+
+    void counted_free ( void * data )
+    {
+        std::free(data);
+    }
+
+    // Keeps results alive so the measured loops aren't optimized away.
+    volatile std::size_t sink = 0;
+
+    typedef std::chrono::steady_clock clock_type;
+
+    double seconds_since ( clock_type::time_point start )
+    {
+        return (std::chrono::duration<double>(clock_type::now()-start)
+                .count());
+    }
+
+    struct corpus
+    {
+        const char * name;
+        const char * pattern;
+        std::string text;
+    };
+
+    // Synthetic, but shaped like the real thing.  Deterministic, so runs
+    // can be compared with each other.
+    std::string make_text ( const char * name, std::size_t size )
+    {
+        static const char * levels[] = { "INFO", "DEBUG", "WARN", "ERROR" };
+        static const char * hosts[] = {
+            "www.example.com", "api.example.org", "cdn.example.net",
+        };
+        char line[256];
+        std::string text;
+        text.reserve(size+sizeof(line));
+        for (unsigned long i=0; text.size() < size; ++i)
+        {
+            const unsigned long r = (i*2654435761ul) >> 7;
+            if (name[0] == 'l') {
+                std::sprintf(line,
+                    "2012-06-%02lu %02lu:%02lu:%02lu.%03lu [%s] worker-%lu: "
+                    "request %lu took %lu ms from 10.0.%lu.%lu\n",
+                    1+i%28, r%24, r%60, (r/60)%60, r%1000, levels[r%4],
+                    r%16, i, r%500, r%256, (r/256)%256);
+            }
+            else if (name[0] == 'u') {
+                std::sprintf(line,
+                    "%s://%s/api/v%lu/items/%lu?id=%lu&q=term%lu\n",
+                    (r%3 == 0)? "http" : "https", hosts[r%3],
+                    1+r%2, r%10000, i, r%97);
+            }
+            else {
+                std::sprintf(line,
+                    "%lu,User %lu,%lu,user%lu@example.com,2012-%02lu-%02lu\n",
+                    i, r%5000, 18+r%60, r%5000, 1+r%12, 1+r%28);
+            }
+            text += line;
+        }
+        return (text);
+    }
+
+    template<class C>
+    std::basic_string<C> widen ( const std::string& text )
+    {
+        return (std::basic_string<C>(text.begin(), text.end()));
+    }
+
+    const char * study_name ( int mode )
+    {
+        static const char * names[] = { "none", "study", "jit" };
+        return (names[mode]);
+    }
+
+    pcrexx::study_options study_mode ( int mode )
+    {
+        pcrexx::study_options options;
+        if (mode == 1) {
+            options.optimize();
+        }
+        if (mode == 2) {
+            options.jit();
+        }
+        return (options);
+    }
+
+    template<class C>
+    void run ( const char * type, const corpus& corpus, int mode )
+    {
+        typedef pcrexx::basic_pattern<C> pattern_type;
+        typedef pcrexx::basic_match<C> match_type;
+        typedef pcrexx::basic_match_view<C> view_type;
+        typedef typename pcrexx::basic_match_range<C>::iterator iterator;
+
+        const std::basic_string<C> expression = widen<C>(corpus.pattern);
+        const std::basic_string<C> text = widen<C>(corpus.text);
+        const pcrexx::compile_options compile =
+            pcrexx::compile_options().multiline();
+        const pcrexx::study_options study = study_mode(mode);
+
+        // Compile.
+        const int compiles = 2000;
+        clock_type::time_point start = clock_type::now();
+        for (int i=0; (i < compiles); ++i) {
+            pattern_type pattern(expression, compile, study);
+        }
+        const double compile_time = seconds_since(start)/compiles;
+
+        const pattern_type pattern(expression, compile, study);
+        const int groups = pattern.capturing_groups();
+
+        // Scan: find all matches in the corpus.
+        std::size_t matches = 0;
+        std::size_t before = allocations;
+        start = clock_type::now();
+        const pcrexx::basic_match_range<C> range =
+            pattern.find_all(text.data(), int(text.size()));
+        for (iterator match=range.begin(); (match != range.end()); ++match) {
+            ++matches;
+        }
+        const double scan_time = seconds_since(start);
+        const std::size_t scan_allocations = allocations-before;
+
+        // Extract: visit all groups of all matches using views.
+        std::size_t total = 0;
+        start = clock_type::now();
+        for (iterator match=range.begin(); (match != range.end()); ++match)
+        {
+            const view_type& view = *match;
+            for (int i=1; (i <= groups); ++i) {
+                total += view.group(i).size();
+            }
+        }
+        const double view_time = seconds_since(start);
+
+        // Extract: copy all groups of all matches into strings, one line
+        // at a time, through the (allocating) match objects.
+        std::size_t copies = 0;
+        before = allocations;
+        start = clock_type::now();
+        for (std::size_t base=0; (base < text.size()); )
+        {
+            std::size_t end = text.find(C('\n'), base);
+            if (end == std::basic_string<C>::npos) {
+                end = text.size();
+            }
+            const match_type match(pattern, text.substr(base, end-base));
+            if (match) {
+                copies += match.groups().size();
+            }
+            base = end+1;
+        }
+        const double copy_time = seconds_since(start);
+        const std::size_t copy_allocations = allocations-before;
+
+        const double megabytes =
+            double(text.size()*sizeof(C))/(1024.0*1024.0);
+        const double per_match = (matches > 0)? double(matches) : 1.0;
+        std::printf(
+            "%-8s %-5s %-6s%s %9.2f %9.1f %11.0f %7.2f %9.1f %9.1f %7.2f\n",
+            type, corpus.name, study_name(mode),
+            (mode == 2 && !pattern.jit_compiled())? "*" : " ",
+            compile_time*1e6, megabytes/scan_time, matches/scan_time,
+            scan_allocations/per_match, view_time*1e9/per_match,
+            copy_time*1e9/per_match, copy_allocations/per_match);
+        sink = total+copies;
+    }
+
+}
+
+void * operator new ( std::size_t size )
+{
+    if (void * data = counted_malloc(size? size : 1)) {
+        return (data);
+    }
+    throw (std::bad_alloc());
+}
+
+void operator delete ( void * data ) noexcept
+{
+    counted_free(data);
+}
+
+int main ( int argc, char ** argv )
+try
+{
+    const std::size_t megabytes =
+        (argc > 1)? std::strtoul(argv[1], 0, 10) : 8;
+
+    pcre_malloc = &counted_malloc, pcre_free = &counted_free;
+#if WCHAR_MAX > 0xffff
+    pcre32_malloc = &counted_malloc, pcre32_free = &counted_free;
+#else
+    pcre16_malloc = &counted_malloc, pcre16_free = &counted_free;
+#endif
+
+    corpus corpora[] = {
+        { "logs",
+          "\\[(?<level>ERROR|WARN)\\] (?<source>[\\w-]+): "
+          ".*?took (?<ms>\\d+) ms", std::string() },
+        { "urls",
+          "(?<scheme>https?)://(?<host>[^/\\s]+)(?<path>/[^\\s?]*)?"
+          "(?:\\?(?<query>\\S*))?", std::string() },
+        { "csv",
+          "^(\\d+),([^,]*),(\\d+),([^,@]+)@([^,]+),"
+          "(\\d{4})-(\\d\\d)-(\\d\\d)$", std::string() },
+    };
+    const std::size_t count = sizeof(corpora)/sizeof(corpora[0]);
+    for (std::size_t i=0; (i < count); ++i) {
+        corpora[i].text = make_text(corpora[i].name, megabytes << 20);
+    }
+
+    std::printf(
+        "%-8s %-5s %-7s %9s %9s %11s %7s %9s %9s %7s\n",
+        "type", "text", "study", "compile", "scan", "scan",
+        "allocs", "views", "copies", "allocs");
+    std::printf(
+        "%-8s %-5s %-7s %9s %9s %11s %7s %9s %9s %7s\n",
+        "", "", "", "us", "MB/s", "matches/s",
+        "/match", "ns/match", "ns/match", "/match");
+    for (std::size_t i=0; (i < count); ++i)
+    {
+        for (int mode=0; (mode < 3); ++mode)
+        {
+            run<char>("pattern", corpora[i], mode);
+            run<wchar_t>("wpattern", corpora[i], mode);
+        }
+    }
+    std::printf("(*: JIT not available, using the interpreter)\n");
+}
+catch (const std::exception& error)
+{
+    std::cerr
+        << "Uncaught exception: '" << error.what() << "'!"
+        << std::endl;
+    return (EXIT_FAILURE);
+}
+catch (...)
+{
+    std::cerr
+        << "Uncaught exception!"
+        << std::endl;
+    return (EXIT_FAILURE);
+}
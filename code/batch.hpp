@@ -0,0 +1,209 @@
+#ifndef _pcrexx_batch_hpp__
+#define _pcrexx_batch_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file batch.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "options.hpp"
+#include "pattern.hpp"
+#include "string_ref.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Results of matching one pattern against many subjects.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * Results are stored in a flat table, with one row per subject: a
+     * status column, and the group offsets (relative to the subject) in
+     * PCRE's output vector layout.  The table is reused by each call to
+     * @c match(), so a batch object that is kept around stops allocating
+     * once it has grown to the largest batch size.
+     *
+     * Unlike other match objects, errors for individual subjects (such as
+     * invalid UTF-8) are recorded in the status column instead of thrown,
+     * so one bad record doesn't abort the whole batch.
+     */
+    template<class C>
+    class basic_match_batch
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef basic_string_ref<char_type> string_ref_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        std::size_t mySize;
+        int myStride;
+        std::vector<int> myStatus;
+        std::vector<int> myResults;
+
+        /* construction. */
+    public:
+        basic_match_batch ()
+            : mySize(0), myStride(0)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Match @a count subjects stored back to back in @a data.
+         * @param offsets Array of @a count+1 offsets into @a data: subject
+         *  @c i spans <tt>[offsets[i],offsets[i+1])</tt>.
+         */
+        template<class S>
+        void match ( const basic_pattern<C,S>& pattern, const_char_ptr data,
+                     const std::size_t * offsets, std::size_t count,
+                     runtime_options options=runtime_options() )
+        {
+            prepare(pattern, count);
+            for (std::size_t i=0; (i < count); ++i) {
+                execute(pattern, i, data+offsets[i],
+                        int(offsets[i+1]-offsets[i]), options);
+            }
+        }
+
+        /*!
+         * @brief Match @a count subjects.
+         */
+        template<class S>
+        void match ( const basic_pattern<C,S>& pattern,
+                     const string_ref_type * subjects, std::size_t count,
+                     runtime_options options=runtime_options() )
+        {
+            prepare(pattern, count);
+            for (std::size_t i=0; (i < count); ++i) {
+                execute(pattern, i, subjects[i].data(),
+                        int(subjects[i].size()), options);
+            }
+        }
+
+        /*!
+         * @brief Number of subjects in the last batch.
+         */
+        std::size_t size () const
+        {
+            return (mySize);
+        }
+
+        /*!
+         * @brief Match status for subject @a i.
+         *
+         * This is the number of groups reported (including the entire
+         * match) if the subject matched, 0 if it didn't and a negative PCRE
+         * error code if matching failed.
+         */
+        int status ( std::size_t i ) const
+        {
+            return (myStatus[i]);
+        }
+
+        bool matched ( std::size_t i ) const
+        {
+            return (myStatus[i] > 0);
+        }
+
+        /*!
+         * @brief Offset of group @a j in subject @a i, -1 if unset.
+         */
+        int group_base ( std::size_t i, int j=0 ) const
+        {
+            return ((j < myStatus[i])? myResults[i*myStride+2*j] : -1);
+        }
+
+        /*!
+         * @brief Size of group @a j in subject @a i.
+         */
+        int group_size ( std::size_t i, int j=0 ) const
+        {
+            const int * row = &myResults[i*myStride];
+            return ((j < myStatus[i])? row[2*j+1]-row[2*j] : 0);
+        }
+
+        /*!
+         * @brief Output vector for subject @a i.
+         */
+        const int * row ( std::size_t i ) const
+        {
+            return (&myResults[i*myStride]);
+        }
+
+        /*!
+         * @brief Number of integers in each row of the table.
+         */
+        int stride () const
+        {
+            return (myStride);
+        }
+
+    private:
+        template<class S>
+        void prepare ( const basic_pattern<C,S>& pattern, std::size_t count )
+        {
+            mySize = count;
+            myStride = (1+pattern.capturing_groups())*3;
+            myStatus.resize(count);
+            myResults.resize(count*myStride);
+        }
+
+        template<class S>
+        void execute ( const basic_pattern<C,S>& pattern, std::size_t i,
+                       const_char_ptr data, int size, runtime_options options )
+        {
+            int status = pattern.execute
+                (detail::subject(data), size, 0, options,
+                 &myResults[i*myStride], myStride);
+            if (status == PCRE_ERROR_NOMATCH) {
+                status = 0;
+            }
+            else if (status == 0) {
+                status = myStride/3;
+            }
+            myStatus[i] = status;
+        }
+    };
+
+    typedef basic_match_batch<char> match_batch;
+    typedef basic_match_batch<wchar_t> wmatch_batch;
+
+}
+
+#endif /* _pcrexx_batch_hpp__ */
@@ -0,0 +1,391 @@
+#ifndef _pcrexx_bundle_hpp__
+#define _pcrexx_bundle_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file bundle.hpp
+ * @see http://www.pcre.org/original/doc/html/pcreprecompile.html
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Layout of pattern bundles.
+     *
+     * A bundle starts with a header, followed by one entry per pattern.
+     * Each entry holds three 64-bit sizes (regular expression length in
+     * characters, compiled pattern and study data in bytes) followed by
+     * the null-terminated regular expression, the compiled pattern and the
+     * study data.  All parts are padded to 8 bytes.  Everything is stored
+     * in native byte order.
+     */
+    struct bundle_format
+    {
+        static const std::size_t alignment = 8;
+
+        // PCRE reads the first 16 bytes of a compiled pattern (magic
+        // number, size, options and flags) to check it.
+        static const std::size_t minimum_compiled = 16;
+
+        /*!
+         * @brief Bundle header, identifying the format and the build that
+         *  produced it.
+         */
+        struct header
+        {
+            char magic[8];
+            unsigned int version;
+            unsigned int byte_order;
+            unsigned int pcre_major;
+            unsigned int pcre_minor;
+            unsigned int char_size;
+            unsigned int unit_size;
+            unsigned int pointer_size;
+            unsigned int count;
+
+            template<class C>
+            static header current ( std::size_t count )
+            {
+                const header value = {
+                    { 'p', 'c', 'r', 'e', 'x', 'x', 'b', '\0' },
+                    1, 0x01020304, PCRE_MAJOR, PCRE_MINOR,
+                    sizeof(C), unsigned(traits<C>::unit_size()),
+                    sizeof(void*), unsigned(count)
+                };
+                return (value);
+            }
+        };
+
+        static std::size_t padded ( std::size_t size )
+        {
+            return ((size + alignment-1) / alignment * alignment);
+        }
+
+        // Size of the smallest entry: an empty expression, a compiled
+        // pattern's header and no study data.
+        template<class C>
+        static std::size_t minimum_entry ()
+        {
+            return (padded(3*sizeof(unsigned long long)) +
+                    padded(sizeof(C)) + padded(minimum_compiled));
+        }
+    };
+
+    /*!
+     * @brief Bundle that can't be loaded.
+     *
+     * Codes are @c bundle_exception::error values rather than PCRE error
+     * codes, see @c reason().
+     */
+    class bundle_exception :
+        public exception
+    {
+        /* nested types. */
+    public:
+        enum error
+        {
+            misaligned = 1,
+            truncated,
+            bad_format,
+            bad_byte_order,
+            bad_build,
+            bad_text,
+            bad_pattern
+        };
+
+        /* construction. */
+    public:
+        bundle_exception ( error code, const char * help="" )
+            : exception(code, help)
+        {}
+
+        /* methods. */
+    public:
+        error reason () const
+        {
+            return (error(code()));
+        }
+    };
+
+    /*!
+     * @brief Build a bundle of precompiled patterns.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * Compile patterns as usual (and study them to save the study data),
+     * add them, then save @c data() to a file.  Load the file later (e.g.
+     * memory-mapped, see "mapped_file.hpp") with @c basic_pattern_bundle
+     * to skip compilation.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_bundle_writer
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+
+        /* data. */
+    private:
+        std::size_t myCount;
+        std::vector<char> myData;
+
+        /* construction. */
+    public:
+        basic_bundle_writer ()
+            : myCount(0), myData(sizeof(bundle_format::header), 0)
+        {
+            update();
+        }
+
+        /* methods. */
+    public:
+        void add ( const pattern_type& pattern )
+        {
+            const unsigned long long sizes[3] = {
+                std::char_traits<C>::length(pattern.text().c_str()),
+                pattern.compiled_size(),
+                pattern.study_size(),
+            };
+            append(sizes, sizeof(sizes));
+            append(pattern.text().c_str(), (sizes[0]+1)*sizeof(C));
+            append(pattern.handle(), std::size_t(sizes[1]));
+            append(pattern.study_data(), std::size_t(sizes[2]));
+            ++myCount, update();
+        }
+
+        /*!
+         * @brief Number of patterns in the bundle.
+         */
+        std::size_t size () const
+        {
+            return (myCount);
+        }
+
+        /*!
+         * @brief Serialized bundle.
+         */
+        const std::vector<char>& data () const
+        {
+            return (myData);
+        }
+
+        void write ( std::ostream& stream ) const
+        {
+            stream.write(&myData[0], myData.size());
+        }
+
+    private:
+        void append ( const void * data, std::size_t size )
+        {
+            const char * bytes = static_cast<const char*>(data);
+            myData.insert(myData.end(), bytes, bytes+size);
+            myData.resize(bundle_format::padded(myData.size()), 0);
+        }
+
+        void update ()
+        {
+            const bundle_format::header header =
+                bundle_format::header::current<C>(myCount);
+            std::memcpy(&myData[0], &header, sizeof(header));
+        }
+    };
+
+    /*!
+     * @brief Patterns loaded from a bundle, without compiling them.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * The bundle is checked against the running build (format version,
+     * byte order, PCRE version, character and pointer sizes) and rejected
+     * with a @c bundle_exception if anything differs, or if the sizes of
+     * its entries don't add up.  Patterns refer to the bundle directly, so
+     * it must stay in memory (and 8-byte aligned) as long as the patterns
+     * are used.
+     *
+     * @note Pattern bundles are immutable and thread-safe.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_pattern_bundle
+    {
+        // Not copyable.
+        basic_pattern_bundle ( const basic_pattern_bundle& );
+        basic_pattern_bundle& operator= ( const basic_pattern_bundle& );
+
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef S string_type;
+        typedef basic_pattern<C,S> pattern_type;
+
+        /* data. */
+    private:
+        std::vector<pattern_type> myPatterns;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Load all patterns in a bundle.
+         * @param study If enabled, patterns are studied again rather than
+         *  using the saved study data.  This is required for JIT
+         *  compilation, since machine code can't be saved.
+         */
+        basic_pattern_bundle ( const void * data, std::size_t size,
+                               study_options study=study_options() )
+        {
+            const char * bytes = static_cast<const char*>(data);
+            if ((reinterpret_cast<std::size_t>(bytes) %
+                 bundle_format::alignment) != 0) {
+                throw (bundle_exception
+                       (bundle_exception::misaligned, "bundle: alignment"));
+            }
+            const bundle_format::header expected =
+                bundle_format::header::current<C>(0);
+            bundle_format::header header;
+            if (size < sizeof(header)) {
+                throw (bundle_exception
+                       (bundle_exception::truncated, "bundle: truncated"));
+            }
+            std::memcpy(&header, bytes, sizeof(header));
+            if ((std::memcmp(header.magic, expected.magic,
+                             sizeof(header.magic)) != 0) ||
+                (header.version != expected.version)) {
+                throw (bundle_exception
+                       (bundle_exception::bad_format, "bundle: format"));
+            }
+            if (header.byte_order != expected.byte_order) {
+                throw (bundle_exception(bundle_exception::bad_byte_order,
+                                        "bundle: byte order"));
+            }
+            if ((header.pcre_major != expected.pcre_major) ||
+                (header.pcre_minor != expected.pcre_minor) ||
+                (header.char_size != expected.char_size) ||
+                (header.unit_size != expected.unit_size) ||
+                (header.pointer_size != expected.pointer_size)) {
+                throw (bundle_exception
+                       (bundle_exception::bad_build, "bundle: build"));
+            }
+            // Check the count before trusting it to reserve storage.
+            if (header.count > (size-sizeof(header)) /
+                bundle_format::minimum_entry<C>()) {
+                throw (bundle_exception
+                       (bundle_exception::truncated, "bundle: truncated"));
+            }
+            std::size_t offset = sizeof(header);
+            myPatterns.reserve(header.count);
+            for (unsigned int i=0; (i < header.count); ++i) {
+                offset = load(bytes, size, offset, study);
+            }
+        }
+
+        /* methods. */
+    public:
+        std::size_t size () const
+        {
+            return (myPatterns.size());
+        }
+
+    private:
+        std::size_t load ( const char * data, std::size_t size,
+                           std::size_t offset, study_options study )
+        {
+            unsigned long long sizes[3];
+            if (size-offset < sizeof(sizes)) {
+                throw (bundle_exception
+                       (bundle_exception::truncated, "bundle: truncated"));
+            }
+            std::memcpy(sizes, data+offset, sizeof(sizes));
+            const std::size_t parts[3] = {
+                bundle_format::padded(sizeof(sizes)),
+                bundle_format::padded(std::size_t((sizes[0]+1)*sizeof(C))),
+                bundle_format::padded(std::size_t(sizes[1])),
+            };
+            const std::size_t total = parts[0] + parts[1] + parts[2] +
+                bundle_format::padded(std::size_t(sizes[2]));
+            if ((sizes[0] > size) || (sizes[1] > size) ||
+                (sizes[2] > size) || (size-offset < total)) {
+                throw (bundle_exception
+                       (bundle_exception::truncated, "bundle: truncated"));
+            }
+            if (sizes[1] < bundle_format::minimum_compiled) {
+                throw (bundle_exception
+                       (bundle_exception::bad_pattern, "bundle: pattern"));
+            }
+            const char * text = data + offset + parts[0];
+            const char * compiled = text + parts[1];
+            const char * studied = compiled + parts[2];
+            // Only read the expression within its recorded size.
+            const C * units = reinterpret_cast<const C*>(text);
+            const std::size_t length = std::size_t(sizes[0]);
+            if (units[length] != C()) {
+                throw (bundle_exception
+                       (bundle_exception::bad_text, "bundle: text"));
+            }
+            // PCRE reads the compiled pattern up to the size recorded in
+            // it, which must then be within the entry.
+            std::size_t recorded = 0;
+            const int status = traits<C>::query
+                (traits<C>::load(compiled), 0, PCRE_INFO_SIZE, &recorded);
+            if ((status != 0) || (recorded != sizes[1])) {
+                throw (bundle_exception
+                       (bundle_exception::bad_pattern, "bundle: pattern"));
+            }
+            myPatterns.push_back(pattern_type
+                (string_type(units, length),
+                 compiled, (sizes[2] == 0)? 0 : studied, study));
+            return (offset + total);
+        }
+
+        /* operators. */
+    public:
+        const pattern_type& operator[] ( std::size_t i ) const
+        {
+            return (myPatterns[i]);
+        }
+    };
+
+    typedef basic_bundle_writer<char> bundle_writer;
+    typedef basic_bundle_writer<wchar_t> wbundle_writer;
+
+    typedef basic_pattern_bundle<char> pattern_bundle;
+    typedef basic_pattern_bundle<wchar_t> wpattern_bundle;
+
+}
+
+#endif /* _pcrexx_bundle_hpp__ */
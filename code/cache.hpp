@@ -0,0 +1,227 @@
+#ifndef _pcrexx_cache_hpp__
+#define _pcrexx_cache_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file cache.hpp
+ */
+
+#include "memory.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Bounded cache of compiled patterns.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.  Must also have an
+     *  @c operator<.
+     *
+     * Patterns are keyed by their text and compile options, and shared
+     * with callers through reference counting, so evicting a pattern never
+     * invalidates a pattern that is still in use.  When the cache is full,
+     * the least recently used pattern is evicted.
+     *
+     * Patterns are compiled outside the cache's lock, so a slow compile
+     * doesn't block lookups from other threads.  If two threads miss on
+     * the same pattern at once, both compile it and one result is kept.
+     *
+     * @note Caches are thread-safe.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_pattern_cache
+    {
+        // Not copyable.
+        basic_pattern_cache ( const basic_pattern_cache& );
+        basic_pattern_cache& operator= ( const basic_pattern_cache& );
+
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef S string_type;
+
+        typedef basic_pattern<C,S> pattern_type;
+        typedef std::shared_ptr<const pattern_type> pointer;
+
+    private:
+        typedef std::pair<string_type,int> key_type;
+        typedef std::pair<key_type,pointer> entry_type;
+        typedef std::list<entry_type> usage_type;
+        typedef std::map<key_type,typename usage_type::iterator> index_type;
+
+        /* data. */
+    private:
+        const std::size_t myCapacity;
+        const study_options myStudyOptions;
+        mutable std::mutex myLock;
+        usage_type myUsage;
+        index_type myIndex;
+        std::atomic<unsigned long long> myHits;
+        std::atomic<unsigned long long> myMisses;
+        std::atomic<unsigned long long> myEvictions;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Build an empty cache.
+         * @param capacity Maximum number of patterns kept in the cache.
+         * @param study Options used to study all patterns in the cache.
+         */
+        explicit basic_pattern_cache ( std::size_t capacity,
+                                       study_options study=study_options() )
+            : myCapacity(capacity), myStudyOptions(study),
+              myHits(0), myMisses(0), myEvictions(0)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Get a compiled pattern, compiling it if necessary.
+         *
+         * Compilation errors are thrown as usual, and are not cached.
+         */
+        pointer get ( const string_type& text,
+                      compile_options options=compile_options() )
+        {
+            // Cached patterns outlive the caller's memory scope, if any.
+            const memory_scope heap(heap_resource::instance());
+            const key_type key(text, int(options));
+            {
+                std::lock_guard<std::mutex> guard(myLock);
+                const typename index_type::iterator match = myIndex.find(key);
+                if (match != myIndex.end())
+                {
+                    // Move to the front of the list.
+                    myUsage.splice(myUsage.begin(), myUsage, match->second);
+                    ++myHits;
+                    return (match->second->second);
+                }
+            }
+            ++myMisses;
+            const pointer pattern
+                (new pattern_type(text, options, myStudyOptions));
+            std::lock_guard<std::mutex> guard(myLock);
+            const typename index_type::iterator match = myIndex.find(key);
+            if (match != myIndex.end()) {
+                // Another thread got there first.
+                return (match->second->second);
+            }
+            if (myCapacity == 0) {
+                return (pattern);
+            }
+            myUsage.push_front(entry_type(key, pattern));
+            try {
+                myIndex.insert(std::make_pair(key, myUsage.begin()));
+            }
+            catch (...) {
+                myUsage.pop_front(); throw;
+            }
+            while (myUsage.size() > myCapacity)
+            {
+                myIndex.erase(myUsage.back().first);
+                myUsage.pop_back();
+                ++myEvictions;
+            }
+            return (pattern);
+        }
+
+        /*!
+         * @brief Drop all patterns from the cache.
+         *
+         * Counters are not reset.
+         */
+        void clear ()
+        {
+            std::lock_guard<std::mutex> guard(myLock);
+            myIndex.clear(), myUsage.clear();
+        }
+
+        /*!
+         * @brief Maximum number of patterns kept in the cache.
+         */
+        std::size_t capacity () const
+        {
+            return (myCapacity);
+        }
+
+        /*!
+         * @brief Number of patterns currently in the cache.
+         */
+        std::size_t size () const
+        {
+            std::lock_guard<std::mutex> guard(myLock);
+            return (myUsage.size());
+        }
+
+        /*!
+         * @brief Number of lookups that found a compiled pattern.
+         */
+        unsigned long long hits () const
+        {
+            return (myHits.load());
+        }
+
+        /*!
+         * @brief Number of lookups that had to compile the pattern.
+         */
+        unsigned long long misses () const
+        {
+            return (myMisses.load());
+        }
+
+        /*!
+         * @brief Number of patterns evicted to make room for others.
+         */
+        unsigned long long evictions () const
+        {
+            return (myEvictions.load());
+        }
+    };
+
+    /*!
+     * @brief Pattern cache for UTF-8 strings stored in @c std::string.
+     */
+    typedef basic_pattern_cache<char> pattern_cache;
+
+    /*!
+     * @brief Pattern cache for wide strings stored in @c std::wstring.
+     */
+    typedef basic_pattern_cache<wchar_t> wpattern_cache;
+
+}
+
+#endif /* _pcrexx_cache_hpp__ */
@@ -0,0 +1,323 @@
+#ifndef _pcrexx_dfa_hpp__
+#define _pcrexx_dfa_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file dfa.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "string_ref.hpp"
+#include "traits.hpp"
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Result of a match using the alternative (DFA) algorithm.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * The DFA algorithm finds all matches that start at the first matching
+     * position in a single pass over the subject, instead of backtracking.
+     * All matches share the same start offset and are sorted by decreasing
+     * size: match 0 is the longest.  Capturing groups are not supported.
+     *
+     * @note Like @c basic_match_view, this refers to storage owned by the
+     *  @c basic_dfa_matcher that produced it, which is reused by the next
+     *  match.
+     */
+    template<class C>
+    class basic_dfa_match
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        typedef basic_string_ref<char_type> string_ref_type;
+
+        /* data. */
+    private:
+        const_char_ptr myData;
+        int mySize;
+        const int * myResults;
+        int myMatches;
+        bool myPartial;
+
+        /* construction. */
+    public:
+        basic_dfa_match ()
+            : myData(0), mySize(0), myResults(0), myMatches(0),
+              myPartial(false)
+        {}
+
+        basic_dfa_match ( const_char_ptr data, int size,
+                          const int * results, int matches, bool partial )
+            : myData(data), mySize(size), myResults(results),
+              myMatches(matches), myPartial(partial)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Subject text.
+         */
+        const_char_ptr data () const
+        {
+            return (myData);
+        }
+
+        /*!
+         * @brief Size of subject text.
+         */
+        int size () const
+        {
+            return (mySize);
+        }
+
+        /*!
+         * @brief Number of matches reported, 0 if there was no match.
+         *
+         * When there are more matches than the matcher has room for, only
+         * the longest ones are reported.
+         */
+        int matches () const
+        {
+            return (myMatches);
+        }
+
+        /*!
+         * @brief Check if the subject ended in the middle of a match.
+         *
+         * This only happens when matching with one of the partial options.
+         * The next segment of the subject can be matched by passing @c
+         * runtime_options::dfa_restart() to the same matcher.
+         */
+        bool partial () const
+        {
+            return (myPartial);
+        }
+
+        /*!
+         * @brief Get the offset at which all matches (or the partial match)
+         *  start.
+         */
+        int match_base () const
+        {
+            return (myResults[0]);
+        }
+
+        /*!
+         * @brief Get the size of the @a i-th longest match.
+         */
+        int match_size ( int i=0 ) const
+        {
+            return ((i >= 0 && i < myMatches)?
+                    myResults[2*i+1]-myResults[2*i] : 0);
+        }
+
+        /*!
+         * @brief Refer to the @a i-th longest match.
+         */
+        string_ref_type match ( int i=0 ) const
+        {
+            return (string_ref_type(myData+match_base(), match_size(i)));
+        }
+
+        /*!
+         * @brief Refer to the longest match.
+         */
+        string_ref_type longest () const
+        {
+            return (match(0));
+        }
+
+        /*!
+         * @brief Refer to the shortest match.
+         */
+        string_ref_type shortest () const
+        {
+            return (match(myMatches-1));
+        }
+
+        /* operators. */
+    public:
+        /*!
+         * @brief Check if there was a (complete) match.
+         */
+        operator bool () const
+        {
+            return (myMatches > 0);
+        }
+
+        bool operator! () const
+        {
+            return (myMatches == 0);
+        }
+    };
+
+    /*!
+     * @brief Matches patterns using the alternative (DFA) algorithm.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * Compiled patterns can be used with either algorithm, so the choice is
+     * made for each match, by using a matcher instead of the pattern's own
+     * call operator (patterns studied with @c study_options::dfa() use the
+     * DFA algorithm in their own call operator too, but only report the
+     * longest match):
+     * @code
+     *  pcrexx::dfa_matcher matcher;
+     *  pcrexx::dfa_match match = matcher(pattern, data, size);
+     *  if (match) {
+     *      // use match.longest(), match.match(i) for i < match.matches()
+     *  }
+     * @endcode
+     *
+     * The matcher owns the output vector and the workspace required by the
+     * DFA algorithm and reuses them across calls, so matching with the same
+     * matcher doesn't allocate once the workspace has grown large enough
+     * for the patterns in use.  The workspace also carries the state needed
+     * to resume a partial match in the next segment of the subject (see @c
+     * runtime_options::dfa_restart()), so such multi-segment matches must
+     * use the same matcher.
+     *
+     * Matches are counted in the pattern's statistics and limit trips,
+     * like any other match.
+     *
+     * @note Matchers are not thread-safe: use one per thread.
+     */
+    template<class C>
+    class basic_dfa_matcher
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        typedef basic_dfa_match<char_type> match_type;
+
+        /* class data. */
+    private:
+        static const int ourMaximumWorkspace = 1024*1024;
+
+        /* data. */
+    private:
+        std::vector<int> myResults;
+        std::vector<int> myWorkspace;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Prepare to report up to @a matches matches.
+         * @param workspace Initial size of the workspace, in integers.  The
+         *  workspace grows as needed for patterns that require more.
+         */
+        explicit basic_dfa_matcher ( int matches=32, int workspace=1000 )
+            : myResults(2*(matches > 0? matches : 1)),
+              myWorkspace(workspace > 20? workspace : 20)
+        {}
+
+    private:
+        basic_dfa_matcher ( const basic_dfa_matcher& );
+        basic_dfa_matcher& operator= ( const basic_dfa_matcher& );
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Get the current size of the workspace, in integers.
+         */
+        int workspace_size () const
+        {
+            return (int(myWorkspace.size()));
+        }
+
+        /* operators. */
+    public:
+        /*!
+         * @brief Match @a size characters at @a data using @a pattern.
+         * @param base Offset at which to start searching.
+         */
+        template<class S>
+        match_type operator() ( const basic_pattern<C,S>& pattern,
+                                const_char_ptr data, int size,
+                                runtime_options options=runtime_options(),
+                                int base=0 )
+        {
+            const bool restart = (options & PCRE_DFA_RESTART) != 0;
+            int status = 0;
+            while (true)
+            {
+                status = pattern.dfa_execute
+                    (data, size, base, options,
+                     &myResults[0], int(myResults.size()),
+                     &myWorkspace[0], int(myWorkspace.size()));
+                if (status != PCRE_ERROR_DFA_WSSIZE) {
+                    break;
+                }
+                // Growing the workspace loses the state of a partial
+                // match, so only retry from scratch.
+                if (restart || myWorkspace.size() >= ourMaximumWorkspace) {
+                    throw (exception(status, "dfa_matcher()"));
+                }
+                myWorkspace.resize(2*myWorkspace.size());
+            }
+            if (status == PCRE_ERROR_PARTIAL) {
+                return (match_type(data, size, &myResults[0], 0, true));
+            }
+            if (status < 0)
+            {
+                if (status != PCRE_ERROR_NOMATCH) {
+                    throw_exception(status, "dfa_matcher()");
+                }
+                return (match_type(data, size, &myResults[0], 0, false));
+            }
+            // A null status means the output vector was too small, but it
+            // still holds the longest matches.
+            const int matches = (status == 0)? int(myResults.size())/2
+                                             : status;
+            return (match_type(data, size, &myResults[0], matches, false));
+        }
+    };
+
+    typedef basic_dfa_match<char> dfa_match;
+    typedef basic_dfa_match<wchar_t> wdfa_match;
+
+    typedef basic_dfa_matcher<char> dfa_matcher;
+    typedef basic_dfa_matcher<wchar_t> wdfa_matcher;
+
+}
+
+#endif /* _pcrexx_dfa_hpp__ */
@@ -32,6 +32,7 @@
  * @see http://www.pcre.org/pcre.txt
  */
 
+#include <pcre.h>
 #include <exception>
 
 namespace pcrexx {
@@ -65,6 +66,44 @@ namespace pcrexx {
         }
     };
 
+    /*!
+     * @brief Match aborted after reaching the match or recursion limit.
+     * @see runtime_options::match_limit()
+     * @see runtime_options::recursion_limit()
+     */
+    class limit_exception :
+        public exception
+    {
+        /* construction. */
+    public:
+        limit_exception ( int code, const char * help="" )
+            : exception(code, help)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Check if the recursion limit (rather than the match limit)
+         *  was reached.
+         */
+        bool recursion () const
+        {
+            return (code() == PCRE_ERROR_RECURSIONLIMIT);
+        }
+    };
+
+    /*!
+     * @brief Throw the exception that matches the PCRE error @a code.
+     */
+    inline void throw_exception ( int code, const char * help="" )
+    {
+        if ((code == PCRE_ERROR_MATCHLIMIT) ||
+            (code == PCRE_ERROR_RECURSIONLIMIT)) {
+            throw (limit_exception(code, help));
+        }
+        throw (exception(code, help));
+    }
+
 }
 
 #endif /*  _pcrexx_exception_hpp__ */
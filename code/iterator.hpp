@@ -0,0 +1,361 @@
+#ifndef _pcrexx_iterator_hpp__
+#define _pcrexx_iterator_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file iterator.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "match_view.hpp"
+#include "memory.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "prefilter.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Forward iterator over successive, non-overlapping matches.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * Each search resumes at the end of the previous match, so lookbehind
+     * assertions still see the text before it.  After an empty match, the
+     * search is retried at the same position for a non-empty match, then
+     * resumes one character further (a UTF-8 or UTF-16 sequence for
+     * patterns compiled in Unicode mode, both characters of a CRLF pair
+     * when CRLF is a newline).
+     *
+     * Text that cannot contain a match is skipped without running PCRE,
+     * see @c basic_prefilter.
+     *
+     * The iterator allocates its output vector once and reuses it for every
+     * match.  The subject text and the pattern must outlive the iterator.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_match_iterator
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef basic_pattern<C,S> pattern_type;
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef basic_match_view<C> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type * pointer;
+        typedef const value_type& reference;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        /* class methods. */
+    private:
+        static bool crlf_is_newline ( int runtime, int compiled )
+        {
+            static const int mask =
+                PCRE_NEWLINE_CR|PCRE_NEWLINE_LF|PCRE_NEWLINE_ANY;
+            int newline = runtime & mask;
+            if (newline == 0) {
+                newline = compiled & mask;
+            }
+            if (newline == 0)
+            {
+                // Use the library's default convention.
+                int value = 0;
+                traits_type::config(PCRE_CONFIG_NEWLINE, &value);
+                return ((value == '\r'*256+'\n') || (value < 0));
+            }
+            return ((newline == PCRE_NEWLINE_CRLF) ||
+                    (newline == PCRE_NEWLINE_ANY) ||
+                    (newline == PCRE_NEWLINE_ANYCRLF));
+        }
+
+        /* data. */
+    private:
+        const pattern_type * myPattern;
+        const_char_ptr myData;
+        int mySize;
+        runtime_options myOptions;
+        bool myUnicode;
+        bool myCrlf;
+        basic_prefilter<C> myFilter;
+        std::vector<int, scoped_allocator<int> > myResults;
+        value_type myMatch;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Build an end-of-sequence iterator.
+         */
+        basic_match_iterator ()
+            : myPattern(0), myData(0), mySize(0), myOptions(),
+              myUnicode(false), myCrlf(false), myFilter(), myResults(),
+              myMatch()
+        {}
+
+        /*!
+         * @brief Find the first match of @a pattern in @a data.
+         */
+        basic_match_iterator ( const pattern_type& pattern,
+                               const_char_ptr data, int size,
+                               runtime_options options=runtime_options() )
+            : myPattern(&pattern), myData(data), mySize(size),
+              myOptions(options),
+              myUnicode((pattern.compiled_options() & PCRE_UTF8) != 0),
+              myCrlf(crlf_is_newline(options, pattern.compiled_options())),
+              myFilter(pattern, options),
+              myResults((1+pattern.capturing_groups())*3, 0),
+              myMatch()
+        {
+            if (!search(0, myOptions)) {
+                finish();
+            }
+            // The subject is valid, no need to check it again.
+            myOptions.no_utf_check();
+        }
+
+        basic_match_iterator ( const basic_match_iterator& other )
+            : myPattern(other.myPattern), myData(other.myData),
+              mySize(other.mySize), myOptions(other.myOptions),
+              myUnicode(other.myUnicode), myCrlf(other.myCrlf),
+              myFilter(other.myFilter), myResults(other.myResults),
+              myMatch()
+        {
+            rebind(other);
+        }
+
+        /* methods. */
+    private:
+        // Point the match at our own copy of the output vector.
+        void rebind ( const basic_match_iterator& other )
+        {
+            if (myPattern != 0) {
+                myMatch = value_type(myData, mySize,
+                                     &myResults[0], other.myMatch.groups());
+            }
+            else {
+                myMatch = value_type();
+            }
+        }
+
+        bool search ( int base, runtime_options options )
+        {
+            // Skip text where no match can start.  Retries after an empty
+            // match are anchored, and not filtered.
+            if ((int(options) & PCRE_ANCHORED) == 0)
+            {
+                if (myFilter.possible(myData, base, mySize)) {
+                    base = myFilter.next(myData, base, mySize);
+                }
+                else {
+                    base = -1;
+                }
+                if (base < 0) {
+                    myMatch = value_type(); return (false);
+                }
+            }
+            myMatch = value_type(*myPattern, myData, mySize,
+                                 &myResults[0], int(myResults.size()),
+                                 options, base);
+            return (myMatch);
+        }
+
+        void finish ()
+        {
+            myPattern = 0, myMatch = value_type();
+        }
+
+        void advance ()
+        {
+            const int base = myResults[0];
+            const int next = myResults[1];
+            if (base != next)
+            {
+                if (!search(next, myOptions)) {
+                    finish();
+                }
+                return;
+            }
+            // Empty match: look for a non-empty match at the same spot
+            // before moving on to the next character.
+            if (next == mySize) {
+                finish(); return;
+            }
+            runtime_options options = myOptions;
+            options.not_empty_at_start().anchored();
+            if (search(next, options)) {
+                return;
+            }
+            int skip = next+1;
+            if (myCrlf && (next+1 < mySize) &&
+                (myData[next] == '\r') && (myData[next+1] == '\n')) {
+                skip = next+2;
+            }
+            else if (myUnicode) {
+                skip = traits_type::next_char(myData, mySize, next);
+            }
+            if (!search(skip, myOptions)) {
+                finish();
+            }
+        }
+
+        /* operators. */
+    public:
+        basic_match_iterator& operator= ( const basic_match_iterator& other )
+        {
+            if (this != &other)
+            {
+                myPattern = other.myPattern;
+                myData = other.myData;
+                mySize = other.mySize;
+                myOptions = other.myOptions;
+                myUnicode = other.myUnicode;
+                myCrlf = other.myCrlf;
+                myFilter = other.myFilter;
+                myResults = other.myResults;
+                rebind(other);
+            }
+            return (*this);
+        }
+
+        reference operator* () const
+        {
+            return (myMatch);
+        }
+
+        pointer operator-> () const
+        {
+            return (&myMatch);
+        }
+
+        basic_match_iterator& operator++ ()
+        {
+            advance(); return (*this);
+        }
+
+        basic_match_iterator operator++ ( int )
+        {
+            basic_match_iterator copy(*this); advance(); return (copy);
+        }
+
+        bool operator== ( const basic_match_iterator& other ) const
+        {
+            if ((myPattern == 0) || (other.myPattern == 0)) {
+                return (myPattern == other.myPattern);
+            }
+            return ((myData == other.myData) &&
+                    (myResults[0] == other.myResults[0]) &&
+                    (myResults[1] == other.myResults[1]));
+        }
+
+        bool operator!= ( const basic_match_iterator& other ) const
+        {
+            return (!(*this == other));
+        }
+    };
+
+    /*!
+     * @brief All matches of a pattern in a subject, for use in loops.
+     *
+     * @code
+     *  pcrexx::match_range matches = pattern.find_all(data, size);
+     *  for (pcrexx::match_iterator i = matches.begin();
+     *       i != matches.end(); ++i)
+     *  {
+     *      // use i->group_base(), i->group_size(), ...
+     *  }
+     * @endcode
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_match_range
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+        typedef basic_match_iterator<C,S> iterator;
+        typedef basic_match_iterator<C,S> const_iterator;
+
+    private:
+        typedef typename traits<C>::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        const pattern_type& myPattern;
+        const_char_ptr myData;
+        int mySize;
+        runtime_options myOptions;
+
+        /* construction. */
+    public:
+        basic_match_range ( const pattern_type& pattern,
+                            const_char_ptr data, int size,
+                            runtime_options options=runtime_options() )
+            : myPattern(pattern), myData(data), mySize(size),
+              myOptions(options)
+        {}
+
+        /* methods. */
+    public:
+        iterator begin () const
+        {
+            return (iterator(myPattern, myData, mySize, myOptions));
+        }
+
+        iterator end () const
+        {
+            return (iterator());
+        }
+    };
+
+    typedef basic_match_iterator<char> match_iterator;
+    typedef basic_match_iterator<wchar_t> wmatch_iterator;
+
+    typedef basic_match_range<char> match_range;
+    typedef basic_match_range<wchar_t> wmatch_range;
+
+    // pattern.find_all(data,size,options) -> match_range.
+    template<class C, class S>
+    basic_match_range<C,S> basic_pattern<C,S>::find_all
+        (const C * data, int size, runtime_options options) const
+    {
+        return (basic_match_range<C,S>(*this, data, size, options));
+    }
+
+}
+
+#endif /* _pcrexx_iterator_hpp__ */
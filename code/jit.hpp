@@ -0,0 +1,174 @@
+#ifndef _pcrexx_jit_hpp__
+#define _pcrexx_jit_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file jit.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "memory.hpp"
+#include "traits.hpp"
+#include <atomic>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Per-thread machine stacks for JIT-compiled patterns.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * JIT-compiled code runs on a dedicated stack which is only 32K by
+     * default, too small for deeply nested patterns.  Each thread lazily
+     * allocates its own stack on its first JIT match and keeps it until it
+     * exits, so matching never allocates after warm-up and a single pattern
+     * object can be shared by any number of threads.
+     *
+     * Patterns compiled with JIT support install @c callback() in their
+     * study data, so the stack is picked up automatically.
+     */
+    template<class C>
+    class jit_stack_pool
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef typename traits_type::jit_stack stack_type;
+
+    private:
+        // Owns the stack for the current thread.
+        class slot
+        {
+            // Not copyable.
+            slot ( const slot& );
+            slot& operator= ( const slot& );
+
+            /* data. */
+        private:
+            stack_type myStack;
+
+            /* construction. */
+        public:
+            slot ()
+                : myStack(0)
+            {}
+
+            ~slot ()
+            {
+                if (myStack != 0) {
+                    traits_type::free_jit_stack(myStack);
+                }
+            }
+
+            /* methods. */
+        public:
+            stack_type get ()
+            {
+                if (myStack == 0) {
+                    // The stack lives as long as the thread.
+                    const memory_scope heap(heap_resource::instance());
+                    myStack = traits_type::allocate_jit_stack
+                        (start_size(), maximum_size());
+                }
+                return (myStack);
+            }
+        };
+
+        /* class data. */
+    private:
+        static std::atomic<int> ourStartSize;
+        static std::atomic<int> ourMaximumSize;
+
+        /* class methods. */
+    private:
+        static slot& local ()
+        {
+            static thread_local slot instance;
+            return (instance);
+        }
+
+    public:
+        /*!
+         * @brief Initial size of newly allocated stacks, in bytes.
+         */
+        static int start_size ()
+        {
+            return (ourStartSize.load(std::memory_order_relaxed));
+        }
+
+        /*!
+         * @brief Size up to which stacks may grow, in bytes.
+         */
+        static int maximum_size ()
+        {
+            return (ourMaximumSize.load(std::memory_order_relaxed));
+        }
+
+        /*!
+         * @brief Change the size of stacks allocated from now on.
+         *
+         * Threads that already own a stack keep it as is.
+         */
+        static void resize ( int start, int maximum )
+        {
+            ourStartSize.store(start, std::memory_order_relaxed);
+            ourMaximumSize.store(maximum, std::memory_order_relaxed);
+        }
+
+        /*!
+         * @brief Obtain the stack for the current thread.
+         *
+         * Call this when a worker thread starts to take the allocation off
+         * the first match.  Returns null if the stack can't be allocated,
+         * in which case PCRE falls back to its default stack.
+         */
+        static stack_type acquire ()
+        {
+            return (local().get());
+        }
+
+        /*!
+         * @brief JIT stack callback, for use with @c pcre_assign_jit_stack().
+         */
+        static stack_type callback ( void * )
+        {
+            return (acquire());
+        }
+    };
+
+    template<class C>
+    std::atomic<int> jit_stack_pool<C>::ourStartSize(32*1024);
+
+    template<class C>
+    std::atomic<int> jit_stack_pool<C>::ourMaximumSize(1024*1024);
+
+}
+
+#endif /* _pcrexx_jit_hpp__ */
@@ -0,0 +1,203 @@
+#ifndef _pcrexx_lazy_pattern_hpp__
+#define _pcrexx_lazy_pattern_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file lazy_pattern.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include "memory.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "thread_pool.hpp"
+#include "traits.hpp"
+
+namespace pcrexx {
+
+    /*!
+     * @brief Pattern compiled on first use.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * Patterns declared at namespace scope are compiled during static
+     * initialization, even if they are never used.  Lazy patterns only keep
+     * the expression and options until the pattern is first needed, and
+     * then compile (and study) it exactly once, even when several threads
+     * race for it:
+     * @code
+     *  static const pcrexx::lazy_pattern rule("^(\\w+)=(.*)$");
+     *  ...
+     *  const pcrexx::match match(*rule, line);
+     * @endcode
+     *
+     * If compilation fails, the exception propagates to the caller and the
+     * next use tries again.
+     *
+     * @see warm_up()
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_lazy_pattern
+    {
+        // Not copyable.
+        basic_lazy_pattern ( const basic_lazy_pattern& );
+        basic_lazy_pattern& operator= ( const basic_lazy_pattern& );
+
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+
+        typedef S string_type;
+
+        /* data. */
+    private:
+        string_type myText;
+        compile_options myOptions;
+        study_options myStudy;
+        mutable std::once_flag myOnce;
+        mutable std::unique_ptr<pattern_type> myPattern;
+        mutable std::atomic<bool> myCompiled;
+
+        /* construction. */
+    public:
+        // Note: not explicit, so rule tables can be brace-initialized.
+        basic_lazy_pattern
+            ( const string_type& text,
+              compile_options options=compile_options(),
+              study_options study=study_options() )
+            : myText(text), myOptions(options), myStudy(study),
+              myCompiled(false)
+        {}
+
+        /* methods. */
+    public:
+        const string_type& text () const
+        {
+            return (myText);
+        }
+
+        /*!
+         * @brief Check if the pattern has been compiled yet.
+         */
+        bool compiled () const
+        {
+            return (myCompiled.load(std::memory_order_acquire));
+        }
+
+        /*!
+         * @brief Access the pattern, compiling it if necessary.
+         * @throws exception The expression does not compile.
+         */
+        const pattern_type& get () const
+        {
+            if (!compiled()) {
+                std::call_once(myOnce, &basic_lazy_pattern::compile, this);
+            }
+            return (*myPattern);
+        }
+
+    private:
+        void compile () const
+        {
+            // The pattern outlives the caller's memory scope, if any.
+            const memory_scope heap(heap_resource::instance());
+            myPattern.reset(new pattern_type(myText, myOptions, myStudy));
+            myCompiled.store(true, std::memory_order_release);
+        }
+
+        /* operators. */
+    public:
+        const pattern_type& operator* () const
+        {
+            return (get());
+        }
+
+        const pattern_type * operator-> () const
+        {
+            return (&get());
+        }
+    };
+
+    typedef basic_lazy_pattern<char> lazy_pattern;
+    typedef basic_lazy_pattern<wchar_t> wlazy_pattern;
+
+    /*!
+     * @brief Compile lazy patterns in <tt>[first,last)</tt> in parallel.
+     *
+     * Patterns that are already compiled are skipped.  Threads that use a
+     * pattern while it is being compiled here wait for it rather than
+     * compiling it again.  If some patterns don't compile, the first error
+     * is rethrown once all others are compiled.
+     *
+     * @code
+     *  static const pcrexx::lazy_pattern rules[] = {
+     *      {"^GET (\\S+)"},
+     *      {"^post (\\S+)", pcrexx::compile_options().case_insensitive()},
+     *  };
+     *  ...
+     *  pcrexx::warm_up(pool, std::begin(rules), std::end(rules));
+     * @endcode
+     */
+    template<class Iterator>
+    void warm_up ( thread_pool& pool, Iterator first, Iterator last )
+    {
+        const std::size_t count = std::distance(first, last);
+        pool.run(count, [first] ( std::size_t i )
+        {
+            Iterator item = first; std::advance(item, i);
+            item->get();
+        });
+    }
+
+    /*!
+     * @brief Start compiling lazy patterns in the background.
+     *
+     * Returns immediately, so the program can start while patterns compile.
+     * The pool and patterns must outlive the returned future, which reports
+     * errors as for @c warm_up().
+     */
+    template<class Iterator>
+    std::future<void> warm_up_async
+        ( thread_pool& pool, Iterator first, Iterator last )
+    {
+        return (std::async(std::launch::async, [&pool, first, last] ()
+        {
+            warm_up(pool, first, last);
+        }));
+    }
+
+}
+
+#endif /* _pcrexx_lazy_pattern_hpp__ */
@@ -0,0 +1,889 @@
+#ifndef _pcrexx_literal_hpp__
+#define _pcrexx_literal_hpp__
+
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file literal.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "syntax.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define PCREXX_SSE2
+#   include <emmintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   endif
+#endif
+
+namespace pcrexx {
+
+    namespace detail {
+
+#ifdef PCREXX_SSE2
+        inline int lowest_bit ( unsigned int mask )
+        {
+#   ifdef _MSC_VER
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return (int(index));
+#   else
+            return (__builtin_ctz(mask));
+#   endif
+        }
+
+        // Compare 16 bytes worth of code units at once.
+        template<std::size_t N> struct sse2_units;
+
+        template<> struct sse2_units<1>
+        {
+            static __m128i splat ( int unit ) {
+                return (_mm_set1_epi8(char(unit)));
+            }
+            static __m128i equal ( __m128i lhs, __m128i rhs ) {
+                return (_mm_cmpeq_epi8(lhs, rhs));
+            }
+        };
+
+        template<> struct sse2_units<2>
+        {
+            static __m128i splat ( int unit ) {
+                return (_mm_set1_epi16(short(unit)));
+            }
+            static __m128i equal ( __m128i lhs, __m128i rhs ) {
+                return (_mm_cmpeq_epi16(lhs, rhs));
+            }
+        };
+
+        template<> struct sse2_units<4>
+        {
+            static __m128i splat ( int unit ) {
+                return (_mm_set1_epi32(unit));
+            }
+            static __m128i equal ( __m128i lhs, __m128i rhs ) {
+                return (_mm_cmpeq_epi32(lhs, rhs));
+            }
+        };
+#endif
+
+        /*!
+         * @brief Find the first occurrence of either @a lhs or @a rhs (which
+         *  may be equal) in @a size code units at @a data.
+         * @return The offset of the occurrence, or @a size if there is none.
+         */
+        template<class C>
+        std::size_t find_units ( const C * data, std::size_t size,
+                                 C lhs, C rhs )
+        {
+            std::size_t i = 0;
+#ifdef PCREXX_SSE2
+            typedef sse2_units<sizeof(C)> units;
+            const std::size_t step = 16 / sizeof(C);
+            const __m128i x = units::splat(int(lhs));
+            const __m128i y = units::splat(int(rhs));
+            for (; (i+step <= size); i += step)
+            {
+                const __m128i block = _mm_loadu_si128
+                    (reinterpret_cast<const __m128i*>(data+i));
+                const int mask = _mm_movemask_epi8(_mm_or_si128
+                    (units::equal(block, x), units::equal(block, y)));
+                if (mask != 0) {
+                    return (i + lowest_bit(unsigned(mask))/sizeof(C));
+                }
+            }
+#else
+            if (lhs == rhs)
+            {
+                // Typically memchr() or wmemchr(), which are vectorized.
+                const C * unit =
+                    std::char_traits<C>::find(data, size, lhs);
+                return ((unit == 0)? size : std::size_t(unit-data));
+            }
+#endif
+            for (; (i < size); ++i)
+            {
+                if ((data[i] == lhs) || (data[i] == rhs)) {
+                    return (i);
+                }
+            }
+            return (size);
+        }
+
+        // Code unit as a (non-negative) number.
+        template<class C>
+        unsigned long code ( C unit )
+        {
+            typedef typename std::make_unsigned<C>::type unsigned_type;
+            return (static_cast<unsigned_type>(unit));
+        }
+
+        inline bool letter ( unsigned long unit )
+        {
+            return (((unit >= 'A') && (unit <= 'Z')) ||
+                    ((unit >= 'a') && (unit <= 'z')));
+        }
+
+        inline unsigned long lower ( unsigned long unit )
+        {
+            return (((unit >= 'A') && (unit <= 'Z'))? unit-'A'+'a' : unit);
+        }
+
+        inline unsigned long upper ( unsigned long unit )
+        {
+            return (((unit >= 'a') && (unit <= 'z'))? unit-'a'+'A' : unit);
+        }
+
+        inline bool digit ( unsigned long unit )
+        {
+            return ((unit >= '0') && (unit <= '9'));
+        }
+
+        // Code unit matched by the escape at i (at a backslash), -1 if it
+        // matches anything else (or nothing), -2 if it takes arguments or
+        // isn't understood.
+        template<class C>
+        long escaped ( const C * text, int i )
+        {
+            const unsigned long unit = code(text[i+1]);
+            if (unit >= 128) {
+                return (-2);
+            }
+            if (!letter(unit) && !digit(unit)) {
+                return (long(unit));
+            }
+            switch (unit)
+            {
+            case 'a': return (7);
+            case 'e': return (27);
+            case 'f': return ('\f');
+            case 'n': return ('\n');
+            case 'r': return ('\r');
+            case 't': return ('\t');
+            case 'A': case 'b': case 'B': case 'C': case 'd': case 'D':
+            case 'G': case 'h': case 'H': case 'K': case 'N': case 'R':
+            case 's': case 'S': case 'v': case 'V': case 'w': case 'W':
+            case 'X': case 'z': case 'Z':
+                return (-1);
+            }
+            return (-2);
+        }
+
+        // Whether the group at i (at "(") only holds option letters.
+        // Returns the letters' end in @a end.
+        template<class C>
+        bool option_letters ( const C * text, int i, int& end )
+        {
+            if (text[i+1] != C('?')) {
+                return (false);
+            }
+            for (end = i+2; letter(code(text[end])) ||
+                     (text[end] == C('-')); ++end)
+                ;
+            return (end > i+2);
+        }
+
+        // Whether @a text may switch to extended mode anywhere.  Parts of
+        // the text that aren't groups may be mistaken for this, which only
+        // loses literals.
+        template<class C>
+        bool extended ( const C * text )
+        {
+            for (int i=0; (text[i] != C(0)); ++i)
+            {
+                if ((text[i] == C('(')) && extended(text, i)) {
+                    return (true);
+                }
+            }
+            return (false);
+        }
+
+        // Whether @a text holds "(*ACCEPT" anywhere, even in a nested group
+        // or where it is not a verb.  A match may end at the verb, so
+        // nothing after it is required.
+        template<class C>
+        bool accepts ( const C * text )
+        {
+            static const char verb[] = "(*ACCEPT";
+            for (int i=0; (text[i] != C(0)); ++i)
+            {
+                int j = 0;
+                for (; (verb[j] != 0) && (text[i+j] == C(verb[j])); ++j)
+                    ;
+                if (verb[j] == 0) {
+                    return (true);
+                }
+            }
+            return (false);
+        }
+
+        // Index after the ")" that ends the group at i (at "("), -1 if
+        // none.
+        template<class C>
+        int group_end ( const C * text, int i )
+        {
+            for (int depth=0; (text[i] != C(0));)
+            {
+                if (text[i] == C('\\'))
+                {
+                    if (text[i+1] == C(0)) {
+                        return (-1);
+                    }
+                    i = (text[i+1] == C('Q'))? quote_end(text, i+2) : i+2;
+                }
+                else if (text[i] == C('['))
+                {
+                    i = class_end(text, class_body(text, i+1), true);
+                    if (i < 0) {
+                        return (-1);
+                    }
+                }
+                else if ((text[i] == C('(')) && comment(text, i))
+                {
+                    i = comment_end(text, i+3);
+                    if (i < 0) {
+                        return (-1);
+                    }
+                }
+                else if (text[i] == C('(')) {
+                    ++depth, ++i;
+                }
+                else if (text[i] == C(')'))
+                {
+                    if (--depth == 0) {
+                        return (i+1);
+                    }
+                    ++i;
+                }
+                else {
+                    ++i;
+                }
+            }
+            return (-1);
+        }
+
+        // Minimum count of the quantifier at i, -1 if there is none.
+        // Only tells 0 from more.  @a next receives the index after it.
+        template<class C>
+        int repeats ( const C * text, int i, int& next )
+        {
+            next = i;
+            int minimum = 1;
+            if ((text[i] == C('?')) || (text[i] == C('*'))) {
+                minimum = 0, next = i+1;
+            }
+            else if (text[i] == C('+')) {
+                next = i+1;
+            }
+            else if (text[i] == C('{'))
+            {
+                // Like PCRE, "{" is a literal unless followed by "n}",
+                // "n,}" or "n,m}".
+                int j = i+1;
+                minimum = 0;
+                for (; digit(code(text[j])); ++j)
+                {
+                    if (text[j] != C('0')) {
+                        minimum = 1;
+                    }
+                }
+                if (j == i+1) {
+                    return (-1);
+                }
+                if (text[j] == C(',')) {
+                    for (++j; digit(code(text[j])); ++j)
+                        ;
+                }
+                if (text[j] != C('}')) {
+                    return (-1);
+                }
+                next = j+1;
+            }
+            else {
+                return (-1);
+            }
+            // Lazy or possessive.
+            if ((text[next] == C('?')) || (text[next] == C('+'))) {
+                ++next;
+            }
+            return (minimum);
+        }
+
+        // Longest run of literal code units that every match of @a text
+        // contains: consecutive units at the top level, outside of groups,
+        // that are not optional.  Classes, groups and escapes other than
+        // single characters end a run.  Collecting stops at anything that
+        // changes how the rest reads (option settings, \Q quotes, escapes
+        // with arguments), and alternatives at the top level rule out all
+        // runs, as does (*ACCEPT) anywhere.  Only ASCII units are used,
+        // and in caseless UTF modes, letters are not used at all since
+        // their other case may be outside ASCII (e.g. the Kelvin sign).
+        template<class C>
+        std::vector<C> longest_run ( const C * text, int flags )
+        {
+            const bool caseless = ((flags & PCRE_CASELESS) != 0);
+            const bool unicode = ((flags & PCRE_UTF8) != 0);
+            std::vector<C> run;
+            std::vector<C> best;
+            if (((flags & PCRE_EXTENDED) != 0) || extended(text) ||
+                accepts(text)) {
+                return (best);
+            }
+            bool collect = true;
+            for (int i=0; (text[i] != C(0));)
+            {
+                // Code unit matched by the item at i, if any.
+                long unit = -1;
+                int next = i+1;
+                int end = 0;
+                if ((text[i] == C('|')) || (text[i] == C(')'))) {
+                    return (std::vector<C>());
+                }
+                if (text[i] == C('\\'))
+                {
+                    if (text[i+1] == C(0)) {
+                        break;
+                    }
+                    next = i+2;
+                    if (text[i+1] == C('Q')) {
+                        next = quote_end(text, i+2), collect = false;
+                    }
+                    else if ((unit = escaped(text, i)) == -2) {
+                        collect = false;
+                    }
+                }
+                else if (text[i] == C('['))
+                {
+                    next = class_end(text, class_body(text, i+1), true);
+                }
+                else if (text[i] == C('('))
+                {
+                    if (comment(text, i)) {
+                        next = comment_end(text, i+3);
+                    }
+                    else
+                    {
+                        // Option settings apply to the rest of the text.
+                        if (option_letters(text, i, end) &&
+                            (text[end] == C(')'))) {
+                            collect = false;
+                        }
+                        next = group_end(text, i);
+                    }
+                }
+                else if ((text[i] != C('.')) && (text[i] != C('^')) &&
+                         (text[i] != C('$'))) {
+                    unit = long(code(text[i]));
+                }
+                if (next < 0) {
+                    return (std::vector<C>());
+                }
+                if ((unit >= 128) || (caseless && unicode && letter(unit))) {
+                    unit = -1;
+                }
+                const int minimum = repeats(text, next, next);
+                if (collect && (unit >= 0) && (minimum != 0)) {
+                    run.push_back(C(caseless? lower(unit) : unit));
+                }
+                // Repeated units end the run, since the count is unknown.
+                if (!collect || (unit < 0) || (minimum >= 0))
+                {
+                    if (run.size() > best.size()) {
+                        best.swap(run);
+                    }
+                    run.clear();
+                }
+                i = next;
+            }
+            if (run.size() > best.size()) {
+                best.swap(run);
+            }
+            return (best);
+        }
+
+    }
+
+    /*!
+     * @brief Code units that appear in every match of a pattern.
+     * @tparam C Character type.
+     *
+     * Caseless literals are stored in lower case, and ASCII letters in the
+     * text match either case.
+     */
+    template<class C>
+    class basic_literal
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+
+        /* data. */
+    private:
+        std::vector<C> myUnits;
+        bool myCaseless;
+
+        /* construction. */
+    public:
+        basic_literal ()
+            : myUnits(), myCaseless(false)
+        {}
+
+        basic_literal ( const std::vector<C>& units, bool caseless )
+            : myUnits(units), myCaseless(caseless)
+        {}
+
+        /* methods. */
+    public:
+        bool empty () const
+        {
+            return (myUnits.empty());
+        }
+
+        std::size_t size () const
+        {
+            return (myUnits.size());
+        }
+
+        const std::vector<C>& units () const
+        {
+            return (myUnits);
+        }
+
+        bool caseless () const
+        {
+            return (myCaseless);
+        }
+
+        /*!
+         * @brief Find the first occurrence in @a size code units at
+         *  @a data.
+         * @return The offset of the occurrence, or @a size if there is
+         *  none.
+         *
+         * The first unit is searched for with SSE2 (or memchr()), the rest
+         * is compared where it is found.
+         */
+        std::size_t find ( const C * data, std::size_t size ) const
+        {
+            const std::size_t length = myUnits.size();
+            if (length == 0) {
+                return (0);
+            }
+            const unsigned long head = detail::code(myUnits[0]);
+            const C other = myCaseless? C(detail::upper(head)) : myUnits[0];
+            for (std::size_t i=0; (i+length <= size); ++i)
+            {
+                i += detail::find_units
+                    (data+i, size-length+1-i, myUnits[0], other);
+                if ((i+length <= size) && matches(data+i)) {
+                    return (i);
+                }
+            }
+            return (size);
+        }
+
+    private:
+        bool matches ( const C * data ) const
+        {
+            for (std::size_t i=1; (i < myUnits.size()); ++i)
+            {
+                const unsigned long unit = detail::code(data[i]);
+                if ((unit != detail::code(myUnits[i])) &&
+                    (!myCaseless ||
+                     (detail::lower(unit) != detail::code(myUnits[i])))) {
+                    return (false);
+                }
+            }
+            return (true);
+        }
+
+        /* operators. */
+    public:
+        bool operator== ( const basic_literal& other ) const
+        {
+            return ((myCaseless == other.myCaseless) &&
+                    (myUnits == other.myUnits));
+        }
+
+        bool operator< ( const basic_literal& other ) const
+        {
+            if (myCaseless != other.myCaseless) {
+                return (other.myCaseless);
+            }
+            return (myUnits < other.myUnits);
+        }
+    };
+
+    /*!
+     * @brief Literals found in a pattern when it is compiled.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * PCRE reports the code unit that starts every match (if any) and the
+     * last code unit that every match contains (if any), but not whether
+     * they are caseless, so ASCII letters match either case.  Longer runs
+     * of literal units are read from the regular expression itself.
+     *
+     * As everywhere else, only ASCII units are used, and in UTF modes,
+     * letters that may be caseless are not used at all, since their other
+     * case may be outside ASCII (e.g. the Kelvin sign).
+     *
+     * @see basic_prefilter
+     * @see basic_pattern_set
+     */
+    template<class C>
+    class basic_literals
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+        typedef basic_literal<char_type> literal_type;
+
+    private:
+        typedef typename traits_type::handle handle_type;
+
+        /* class methods. */
+    private:
+        static literal_type unit ( handle_type pattern, int what, int flag,
+                                   bool unicode )
+        {
+            std::uint32_t flags = 0;
+            const int status = traits_type::query(pattern, 0, flag, &flags);
+            if (status != 0) {
+                throw (exception(status, "literal()"));
+            }
+            // Note: a value of 2 means "start of line", not a literal.
+            if (flags != 1) {
+                return (literal_type());
+            }
+            std::uint32_t unit = 0;
+            traits_type::query(pattern, 0, what, &unit);
+            if ((unit >= 128) || (unicode && detail::letter(unit))) {
+                return (literal_type());
+            }
+            return (literal_type(std::vector<C>
+                                 (1, C(detail::lower(unit))), true));
+        }
+
+        /* data. */
+    private:
+        literal_type myFirst;
+        literal_type myRequired;
+        literal_type myLongest;
+
+        /* construction. */
+    public:
+        basic_literals ()
+        {}
+
+        /*!
+         * @brief Find the literals in a compiled pattern.
+         * @param flags Options in effect for the compiled pattern.
+         * @param text Regular expression used to compile the pattern.
+         */
+        basic_literals ( handle_type pattern, int flags, const C * text )
+            : myFirst(unit(pattern, PCRE_INFO_FIRSTCHARACTER,
+                           PCRE_INFO_FIRSTCHARACTERFLAGS,
+                           (flags & PCRE_UTF8) != 0)),
+              myRequired(unit(pattern, PCRE_INFO_REQUIREDCHAR,
+                              PCRE_INFO_REQUIREDCHARFLAGS,
+                              (flags & PCRE_UTF8) != 0)),
+              myLongest(detail::longest_run(text, flags),
+                        (flags & PCRE_CASELESS) != 0)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Code unit that starts every match, if any.
+         */
+        const literal_type& first () const
+        {
+            return (myFirst);
+        }
+
+        /*!
+         * @brief Last code unit that every match contains, if any.
+         */
+        const literal_type& required () const
+        {
+            return (myRequired);
+        }
+
+        /*!
+         * @brief Longest run of literal code units that every match
+         *  contains, if any.
+         */
+        const literal_type& longest () const
+        {
+            return (myLongest);
+        }
+    };
+
+    /*!
+     * @brief Finds which of many literals occur in a text, in one pass.
+     * @tparam C Character type.
+     *
+     * An Aho-Corasick automaton: a trie of the literals, where each state
+     * also links to the longest proper suffix of its text that is in the
+     * trie.  Scanning follows these links on mismatches, so it reads each
+     * code unit of the text once, whatever the number of literals.
+     *
+     * The trie is built on lower case units, so caseless literals match
+     * either case, and occurrences of other literals are compared again
+     * where they end.  Literals only hold ASCII units (see @c
+     * basic_literals), so units outside ASCII always return to the root.
+     *
+     * Each state has a full table of transitions, i.e. 512 bytes, so
+     * literals that share prefixes are cheaper.
+     *
+     * @see basic_pattern_set
+     */
+    template<class C>
+    class basic_literal_scanner
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_literal<char_type> literal_type;
+
+    private:
+        enum { alphabet = 128 };
+
+        struct state_type
+        {
+            // Unit on the transition from the parent.
+            std::int32_t label;
+
+            // First child, and the parent's next child, -1 if none.
+            std::int32_t child;
+            std::int32_t sibling;
+
+            // First literal that ends here, -1 if none.
+            std::int32_t ends;
+
+            // Longest proper suffix in the trie, and the longest one where
+            // a literal ends (0, the root, if none).
+            std::int32_t fail;
+            std::int32_t output;
+        };
+
+        /* data. */
+    private:
+        std::vector<literal_type> myLiterals;
+
+        // Next literal that ends in the same state, -1 if none.
+        std::vector<std::int32_t> mySameEnd;
+
+        std::vector<state_type> myStates;
+
+        // Transitions, 'alphabet' entries per state, -1 if none.
+        std::vector<std::int32_t> myChildren;
+
+        // Breadth-first order of the states, kept to link them.
+        std::vector<std::int32_t> myOrder;
+
+        /* construction. */
+    public:
+        basic_literal_scanner ()
+            : myChildren(alphabet, -1)
+        {
+            const state_type root = { 0, -1, -1, -1, 0, 0 };
+            myStates.push_back(root);
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Number of distinct literals.
+         */
+        std::size_t size () const
+        {
+            return (myLiterals.size());
+        }
+
+        /*!
+         * @brief Add a literal, unless an equal one was added before.
+         * @pre @a literal is not empty and only holds ASCII units.
+         * @return The index of the literal.
+         *
+         * The scanner is left unchanged if this throws.
+         */
+        std::size_t add ( const literal_type& literal )
+        {
+            // Make room first, so that nothing throws once the trie is
+            // being changed.
+            const std::size_t count = myStates.size() + literal.size();
+            myStates.reserve(count);
+            myChildren.reserve(count*alphabet);
+            myOrder.reserve(count);
+            myLiterals.reserve(myLiterals.size()+1);
+            mySameEnd.reserve(myLiterals.size()+1);
+            std::int32_t state = 0;
+            for (std::size_t i=0; (i < literal.size()); ++i)
+            {
+                const std::int32_t unit = std::int32_t
+                    (detail::lower(detail::code(literal.units()[i])));
+                std::int32_t next = myChildren[state*alphabet+unit];
+                if (next < 0)
+                {
+                    next = std::int32_t(myStates.size());
+                    const state_type child =
+                        { unit, -1, myStates[state].child, -1, 0, 0 };
+                    myStates.push_back(child);
+                    myStates[state].child = next;
+                    myChildren[state*alphabet+unit] = next;
+                    myChildren.insert(myChildren.end(), alphabet, -1);
+                }
+                state = next;
+            }
+            for (std::int32_t k = myStates[state].ends; (k >= 0);
+                 k = mySameEnd[k])
+            {
+                if (myLiterals[k] == literal) {
+                    return (std::size_t(k));
+                }
+            }
+            myLiterals.push_back(literal);
+            mySameEnd.push_back(myStates[state].ends);
+            myStates[state].ends = std::int32_t(myLiterals.size()-1);
+            link();
+            return (myLiterals.size()-1);
+        }
+
+        /*!
+         * @brief Access a literal by its index.
+         */
+        const literal_type& operator[] ( std::size_t i ) const
+        {
+            return (myLiterals[i]);
+        }
+
+        /*!
+         * @brief Find which literals occur in @a size code units at
+         *  @a data.
+         * @param found Receives 1 at the index of each literal that
+         *  occurs.  Other entries are left as they are, and they must not
+         *  be 1 to begin with.
+         *
+         * Scanning stops once all literals are found.
+         */
+        void find ( const C * data, std::size_t size,
+                    std::size_t * found ) const
+        {
+            std::size_t missing = myLiterals.size();
+            std::int32_t state = 0;
+            for (std::size_t i=0; (i < size) && (missing > 0); ++i)
+            {
+                const unsigned long unit =
+                    detail::lower(detail::code(data[i]));
+                if (unit >= alphabet) {
+                    state = 0; continue;
+                }
+                while ((state != 0) &&
+                       (myChildren[state*alphabet+unit] < 0)) {
+                    state = myStates[state].fail;
+                }
+                state = std::max
+                    (myChildren[state*alphabet+unit], std::int32_t(0));
+                std::int32_t end = (myStates[state].ends >= 0)?
+                    state : myStates[state].output;
+                for (; (end != 0); end = myStates[end].output)
+                {
+                    for (std::int32_t k = myStates[end].ends; (k >= 0);
+                         k = mySameEnd[k])
+                    {
+                        if ((found[k] != 1) && occurs(k, data, i+1)) {
+                            found[k] = 1, --missing;
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        // Check if literal @a k occurs right before @a end, when it is
+        // known to occur there without regard to case.
+        bool occurs ( std::int32_t k, const C * data, std::size_t end ) const
+        {
+            const literal_type& literal = myLiterals[k];
+            if (literal.caseless()) {
+                return (true);
+            }
+            const std::size_t size = literal.size();
+            for (std::size_t i=0; (i < size); ++i)
+            {
+                if (data[end-size+i] != literal.units()[i]) {
+                    return (false);
+                }
+            }
+            return (true);
+        }
+
+        // Recompute the suffix links of all states.  Only uses storage
+        // reserved by add(), so it doesn't throw.
+        void link ()
+        {
+            myOrder.clear();
+            myOrder.push_back(0);
+            for (std::size_t i=0; (i < myOrder.size()); ++i)
+            {
+                const state_type& parent = myStates[myOrder[i]];
+                for (std::int32_t child = parent.child; (child >= 0);
+                     child = myStates[child].sibling)
+                {
+                    state_type& state = myStates[child];
+                    std::int32_t fail = parent.fail;
+                    while ((fail != 0) &&
+                           (myChildren[fail*alphabet+state.label] < 0)) {
+                        fail = myStates[fail].fail;
+                    }
+                    fail = myChildren[fail*alphabet+state.label];
+                    state.fail = ((fail < 0) || (fail == child))? 0 : fail;
+                    state.output = (myStates[state.fail].ends >= 0)?
+                        state.fail : myStates[state.fail].output;
+                    myOrder.push_back(child);
+                }
+            }
+        }
+    };
+
+}
+
+#endif /* _pcrexx_literal_hpp__ */
@@ -0,0 +1,185 @@
+#ifndef _pcrexx_mapped_file_hpp__
+#define _pcrexx_mapped_file_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file mapped_file.hpp
+ */
+
+#include <cstddef>
+#include <system_error>
+
+#ifdef _WIN32
+    // Don't let <windows.h> define min() and max() macros, which break
+    // std::min(), std::max() and std::numeric_limits<>::max() in headers
+    // included after this one.
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace pcrexx {
+
+    /*!
+     * @brief Read-only memory mapping of an entire file.
+     *
+     * The contents can be searched in place using the functions in
+     * "search.hpp", without copying them into a string first.  The system
+     * is told that the file will be read sequentially.
+     *
+     * Errors are reported using @c std::system_error, with the system
+     * error code.
+     */
+    class mapped_file
+    {
+        // Not copyable.
+        mapped_file ( const mapped_file& );
+        mapped_file& operator= ( const mapped_file& );
+
+        /* class methods. */
+    private:
+        static std::system_error system_error ( int error, const char * help )
+        {
+            return (std::system_error
+                    (error, std::system_category(), help));
+        }
+
+        /* data. */
+    private:
+        const char * myData;
+        std::size_t mySize;
+
+        /* construction. */
+    public:
+        explicit mapped_file ( const char * path )
+            : myData(0), mySize(0)
+        {
+#ifdef _WIN32
+            const ::HANDLE file = ::CreateFileA
+                (path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                 FILE_FLAG_SEQUENTIAL_SCAN, 0);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw (system_error
+                       (int(::GetLastError()), "mapped_file(): open"));
+            }
+            ::LARGE_INTEGER size;
+            if (!::GetFileSizeEx(file, &size)) {
+                const ::DWORD error = ::GetLastError();
+                ::CloseHandle(file);
+                throw (system_error(int(error), "mapped_file(): size"));
+            }
+            if (size.QuadPart == 0) {
+                ::CloseHandle(file); return;
+            }
+            const ::HANDLE mapping = ::CreateFileMappingA
+                (file, 0, PAGE_READONLY, 0, 0, 0);
+            const ::DWORD error = ::GetLastError();
+            ::CloseHandle(file);
+            if (mapping == 0) {
+                throw (system_error(int(error), "mapped_file(): map"));
+            }
+            // Note: the view keeps the mapping alive.
+            myData = static_cast<const char*>
+                (::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            ::CloseHandle(mapping);
+            if (myData == 0) {
+                throw (system_error
+                       (int(::GetLastError()), "mapped_file(): view"));
+            }
+            mySize = static_cast<std::size_t>(size.QuadPart);
+#else
+            const int file = ::open(path, O_RDONLY);
+            if (file < 0) {
+                throw (system_error(errno, "mapped_file(): open"));
+            }
+            struct ::stat status;
+            if (::fstat(file, &status) != 0) {
+                const int error = errno;
+                ::close(file);
+                throw (system_error(error, "mapped_file(): size"));
+            }
+            if (status.st_size == 0) {
+                ::close(file); return;
+            }
+            void * data = ::mmap(0, status.st_size, PROT_READ,
+                                 MAP_PRIVATE, file, 0);
+            const int error = errno;
+            ::close(file);
+            if (data == MAP_FAILED) {
+                throw (system_error(error, "mapped_file(): map"));
+            }
+            ::madvise(data, status.st_size, MADV_SEQUENTIAL);
+            myData = static_cast<const char*>(data);
+            mySize = static_cast<std::size_t>(status.st_size);
+#endif
+        }
+
+        ~mapped_file ()
+        {
+            if (myData == 0) {
+                return;
+            }
+#ifdef _WIN32
+            ::UnmapViewOfFile(myData);
+#else
+            ::munmap(const_cast<char*>(myData), mySize);
+#endif
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief File contents, null for empty files.
+         */
+        const char * data () const
+        {
+            return (myData);
+        }
+
+        /*!
+         * @brief File size, in bytes.
+         */
+        std::size_t size () const
+        {
+            return (mySize);
+        }
+    };
+
+}
+
+#endif /* _pcrexx_mapped_file_hpp__ */
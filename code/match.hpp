@@ -34,10 +34,13 @@
 
 #include <pcre.h>
 #include "exception.hpp"
+#include "memory.hpp"
 #include "options.hpp"
 #include "pattern.hpp"
+#include "string_ref.hpp"
 #include "traits.hpp"
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace pcrexx {
@@ -45,7 +48,8 @@ namespace pcrexx {
     /*!
      * @brief Regular expression search/match result.
      * @tparam C Character type.  @c traits<C> must be defined.  By default,
-     *  it is only @c traits<char> and @c traits<wchar_t> are provided.
+     *  @c traits<char>, @c traits<wchar_t>, @c traits<char16_t> and @c
+     *  traits<char32_t> are provided.
      * @tparam S String type.  Must have a default constructor, copy
      *  constructor, copy-assignment operator and a constructor that accepts
      *  a C-style null-terminated string with @c C as character type.  It must
@@ -67,13 +71,15 @@ namespace pcrexx {
 
         typedef S string_type;
 
-        typedef basic_pattern<char_type> pattern_type;
+        typedef basic_pattern<char_type,string_type> pattern_type;
+
+        typedef basic_string_ref<char_type> string_ref_type;
 
         /* data. */
     private:
         string_type myText;
         int myGroups;
-        std::vector<int> myResults;
+        std::vector<int, scoped_allocator<int> > myResults;
 
         /* construction. */
     public:
@@ -92,13 +98,46 @@ namespace pcrexx {
               myGroups(pattern.capturing_groups()),
               myResults((1+myGroups)*3, 0)
         {
-            const int status = traits_type::execute
-                (pattern.handle(), 0, text.data(), text.size(),
-                 0, options, &myResults[0], myResults.size());
+            execute(pattern, options);
+        }
+
+        /*!
+         * @brief Match @a text using @a pattern, taking over @a text instead
+         *  of copying it.
+         */
+        basic_match ( const pattern_type& pattern, string_type&& text,
+                      runtime_options options=runtime_options() )
+            : myText(std::move(text)),
+              myGroups(pattern.capturing_groups()),
+              myResults((1+myGroups)*3, 0)
+        {
+            execute(pattern, options);
+        }
+
+        basic_match ( const basic_match& other )
+            : myText(other.myText),
+              myGroups(other.myGroups),
+              myResults(other.myResults)
+        {}
+
+        basic_match ( basic_match&& other )
+            : myText(std::move(other.myText)),
+              myGroups(other.myGroups),
+              myResults(std::move(other.myResults))
+        {
+            other.myGroups = 0, other.myResults.clear();
+        }
+
+    private:
+        void execute ( const pattern_type& pattern, runtime_options options )
+        {
+            const int status = pattern.execute
+                (myText.data(), myText.size(), 0, options,
+                 &myResults[0], myResults.size());
             if (status < 0)
             {
                 if (status != PCRE_ERROR_NOMATCH) {
-                    throw (exception(status, "name_table()"));
+                    throw_exception(status, "match()");
                 }
                 myGroups = 0, myResults.clear();
             }
@@ -162,10 +201,58 @@ namespace pcrexx {
             return (myText.substr(group_base(i), group_size(i)));
         }
 
+        /*!
+         * @brief Refer to the entire match, without copying it.
+         */
+        string_ref_type group_ref () const
+        {
+            return (group_ref(0));
+        }
+
+        /*!
+         * @brief Refer to a specific group within the match, without
+         *  copying it.
+         *
+         * Groups that did not participate in the match are empty.
+         */
+        string_ref_type group_ref ( int i ) const
+        {
+            if (!*this || (i > myGroups) || (group_base(i) < 0)) {
+                return (string_ref_type());
+            }
+            return (string_ref_type
+                    (myText.data()+group_base(i), group_size(i)));
+        }
+
+        /*!
+         * @brief Refer to a named group within the match, without copying
+         *  it.
+         *
+         * Unknown names and groups that did not participate in the match
+         * are empty.
+         */
+        string_ref_type group_ref ( const pattern_type& pattern,
+                                    const char_type * name ) const
+        {
+            const int i = pattern.group_index(name);
+            if (i < 0) {
+                return (string_ref_type());
+            }
+            return (group_ref(i));
+        }
+
         /*!
          * @brief Get the contents of all captured groups, in order.
          */
-        std::vector<string_type> groups () const;
+        std::vector<string_type> groups () const
+        {
+            std::vector<string_type> groups;
+            groups.reserve(myGroups);
+            for (int i=1; (i <= myGroups); ++i) {
+                groups.push_back(group(i));
+            }
+            return (groups);
+        }
 
         /*!
          * @brief Get the contents of all captured groups, by name.
@@ -189,6 +276,23 @@ namespace pcrexx {
 
         /* operators. */
     public:
+        basic_match& operator= ( const basic_match& other )
+        {
+            myText = other.myText;
+            myGroups = other.myGroups;
+            myResults = other.myResults;
+            return (*this);
+        }
+
+        basic_match& operator= ( basic_match&& other )
+        {
+            myText = std::move(other.myText);
+            myGroups = other.myGroups;
+            myResults = std::move(other.myResults);
+            other.myGroups = 0, other.myResults.clear();
+            return (*this);
+        }
+
         operator bool () const
         {
             return (myResults.size() > 0);
@@ -201,10 +305,13 @@ namespace pcrexx {
     typedef basic_match<char> match;
 
     /*!
-     * @brief Search/match result for UTF-16 strings stored in @c std::wstring.
+     * @brief Search/match result for wide strings stored in @c std::wstring.
      */
     typedef basic_match<wchar_t> wmatch;
 
+    typedef basic_match<char16_t> u16match;
+    typedef basic_match<char32_t> u32match;
+
     // pattern(text,options) -> match.
     template<class C, class S>
     basic_match<C,S> basic_pattern<C,S>::operator()
@@ -213,6 +320,14 @@ namespace pcrexx {
         return (basic_match<C,S>(*this, text, options));
     }
 
+    // pattern(std::move(text),options) -> match.
+    template<class C, class S>
+    basic_match<C,S> basic_pattern<C,S>::operator()
+        (S&& text, runtime_options options) const
+    {
+        return (basic_match<C,S>(*this, std::move(text), options));
+    }
+
 }
 
 #endif /* _pcrexx_match_hpp__ */
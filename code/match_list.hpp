@@ -0,0 +1,156 @@
+#ifndef _pcrexx_match_list_hpp__
+#define _pcrexx_match_list_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file match_list.hpp
+ */
+
+#include "match_view.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Recorded search/match results.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * Match views are only valid as long as their output vector, which is
+     * usually reused by the next search.  Match lists keep a copy of the
+     * group offsets so the matches can be reported later, e.g. in order
+     * after searching parts of a buffer in parallel.  The subject text is
+     * not copied and must outlive the list.
+     */
+    template<class C>
+    class basic_match_list
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_match_view<C> match_type;
+
+    private:
+        typedef typename traits<C>::const_char_ptr const_char_ptr;
+
+        struct record
+        {
+            const_char_ptr data;
+            int size;
+            int groups;
+            std::size_t base;
+            std::size_t offsets;
+        };
+
+        /* data. */
+    private:
+        std::vector<record> myRecords;
+        std::vector<int> myOffsets;
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Record @a match, found at position @a base.
+         */
+        void push ( const match_type& match, std::size_t base )
+        {
+            const record entry = {
+                match.data(), match.size(), match.groups(),
+                base, myOffsets.size()
+            };
+            for (int i=0; (i < match.groups()); ++i)
+            {
+                myOffsets.push_back(match.group_base(i));
+                myOffsets.push_back(match.group_base(i)+match.group_size(i));
+            }
+            myRecords.push_back(entry);
+        }
+
+        void clear ()
+        {
+            myRecords.clear(), myOffsets.clear();
+        }
+
+        std::size_t size () const
+        {
+            return (myRecords.size());
+        }
+
+        bool empty () const
+        {
+            return (myRecords.empty());
+        }
+
+        /*!
+         * @brief Position of the subject of the @a i-th match in the
+         *  searched buffer.
+         */
+        std::size_t base ( std::size_t i ) const
+        {
+            return (myRecords[i].base);
+        }
+
+        /*!
+         * @brief Position of the @a i-th match in the searched buffer.
+         */
+        std::size_t start ( std::size_t i ) const
+        {
+            return (myRecords[i].base + myOffsets[myRecords[i].offsets]);
+        }
+
+        /*!
+         * @brief Position past the end of the @a i-th match in the searched
+         *  buffer.
+         */
+        std::size_t end ( std::size_t i ) const
+        {
+            return (myRecords[i].base + myOffsets[myRecords[i].offsets+1]);
+        }
+
+        /* operators. */
+    public:
+        /*!
+         * @brief Access the @a i-th match.
+         *
+         * The view is invalidated by @c push() and @c clear().
+         */
+        match_type operator[] ( std::size_t i ) const
+        {
+            const record& entry = myRecords[i];
+            return (match_type(entry.data, entry.size,
+                               &myOffsets[entry.offsets], entry.groups));
+        }
+    };
+
+    typedef basic_match_list<char> match_list;
+    typedef basic_match_list<wchar_t> wmatch_list;
+
+}
+
+#endif /* _pcrexx_match_list_hpp__ */
@@ -0,0 +1,271 @@
+#ifndef _pcrexx_match_view_hpp__
+#define _pcrexx_match_view_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file match_view.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "string_ref.hpp"
+#include "traits.hpp"
+#include <algorithm>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Allocation-free search/match result.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * Unlike @c basic_match, views neither copy the subject text nor own
+     * the storage for the match results: both are supplied by the caller
+     * and must outlive the view.  The results buffer follows PCRE's output
+     * vector conventions: it holds 3 integers per group (including the
+     * entire match as group 0) and groups that don't fit are not reported.
+     *
+     * @code
+     *  int results[3*4];
+     *  pcrexx::match_view match = pattern(data, size, results);
+     *  if (match) {
+     *      // use match.group_base(1), match.group_size(1), ...
+     *  }
+     * @endcode
+     *
+     * @note Match views are cheap to copy.
+     */
+    template<class C>
+    class basic_match_view
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        typedef basic_string_ref<char_type> string_ref_type;
+
+        /* data. */
+    private:
+        const_char_ptr myData;
+        int mySize;
+        const int * myResults;
+        int myGroups;
+
+        /* construction. */
+    public:
+        basic_match_view ()
+            : myData(0), mySize(0), myResults(0), myGroups(0)
+        {}
+
+        /*!
+         * @brief Match @a size characters at @a data using @a pattern.
+         * @param results Output vector, of @a count integers.  @a count
+         *  may be 0 to only check if there is a match.
+         * @param base Offset at which to start searching.  Unlike matching
+         *  at @c data+base, lookbehind assertions can see the text before
+         *  @a base.
+         */
+        template<class S>
+        basic_match_view ( const basic_pattern<C,S>& pattern,
+                           const_char_ptr data, int size,
+                           int * results, int count,
+                           runtime_options options=runtime_options(),
+                           int base=0 )
+            : myData(data), mySize(size), myResults(results), myGroups(0)
+        {
+            const int status = pattern.execute
+                (data, size, base, options, results, count);
+            if (status < 0)
+            {
+                if (status != PCRE_ERROR_NOMATCH) {
+                    throw_exception(status, "match_view()");
+                }
+                return;
+            }
+            // A null status means the output vector was too small, but
+            // the groups that fit are still valid.  Without room for the
+            // entire match (e.g. to only check if there is one), report
+            // the match with an unknown position.
+            if (count < 3)
+            {
+                static const int unknown[2] = { -1, -1 };
+                myResults = unknown;
+            }
+            myGroups = (status == 0)? std::max(1, count/3) : status;
+        }
+
+        /*!
+         * @brief Wrap results of a previous match over @a data.
+         * @param groups Number of groups reported by the match, 0 if there
+         *  was no match.
+         */
+        basic_match_view ( const_char_ptr data, int size,
+                           const int * results, int groups )
+            : myData(data), mySize(size), myResults(results), myGroups(groups)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Subject text.
+         */
+        const_char_ptr data () const
+        {
+            return (myData);
+        }
+
+        /*!
+         * @brief Size of subject text.
+         */
+        int size () const
+        {
+            return (mySize);
+        }
+
+        /*!
+         * @brief Number of groups reported in the results, including the
+         *  entire match.
+         *
+         * Trailing groups that did not participate in the match are not
+         * counted.
+         */
+        int groups () const
+        {
+            return (myGroups);
+        }
+
+        /*!
+         * @brief Get the offset of the entire match.
+         */
+        int group_base () const
+        {
+            return (myResults[0]);
+        }
+
+        /*!
+         * @brief Get the offset of a specific group within the match.
+         */
+        int group_base ( int i ) const
+        {
+            return ((i < myGroups)? myResults[2*i] : -1);
+        }
+
+        /*!
+         * @brief Get the size of the entire match.
+         */
+        int group_size () const
+        {
+            return (myResults[1]-myResults[0]);
+        }
+
+        /*!
+         * @brief Get the size a specific group within the match.
+         */
+        int group_size ( int i ) const
+        {
+            return ((i < myGroups)? myResults[2*i+1]-myResults[2*i] : 0);
+        }
+
+        /*!
+         * @brief Refer to the entire match.
+         */
+        string_ref_type group () const
+        {
+            return (group(0));
+        }
+
+        /*!
+         * @brief Refer to a specific group within the match.
+         *
+         * Groups that did not participate in the match are empty.
+         */
+        string_ref_type group ( int i ) const
+        {
+            const int base = group_base(i);
+            if (base < 0) {
+                return (string_ref_type());
+            }
+            return (string_ref_type(myData+base, group_size(i)));
+        }
+
+        /*!
+         * @brief Refer to a named group within the match.
+         *
+         * Unknown names and groups that did not participate in the match
+         * are empty.
+         */
+        template<class S>
+        string_ref_type group ( const basic_pattern<C,S>& pattern,
+                                const char_type * name ) const
+        {
+            const int i = pattern.group_index(name);
+            if (i < 0) {
+                return (string_ref_type());
+            }
+            return (group(i));
+        }
+
+        /* operators. */
+    public:
+        operator bool () const
+        {
+            return (myGroups > 0);
+        }
+    };
+
+    /*!
+     * @brief Match view for UTF-8 strings.
+     */
+    typedef basic_match_view<char> match_view;
+
+    /*!
+     * @brief Match view for wide strings.
+     */
+    typedef basic_match_view<wchar_t> wmatch_view;
+
+    typedef basic_match_view<char16_t> u16match_view;
+    typedef basic_match_view<char32_t> u32match_view;
+
+    // pattern(data,size,results,count,options) -> match_view.
+    template<class C, class S>
+    basic_match_view<C> basic_pattern<C,S>::operator()
+        (const C * data, int size, int * results, int count,
+         runtime_options options) const
+    {
+        return (basic_match_view<C>
+                (*this, data, size, results, count, options));
+    }
+
+}
+
+#endif /* _pcrexx_match_view_hpp__ */
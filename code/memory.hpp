@@ -0,0 +1,455 @@
+#ifndef _pcrexx_memory_hpp__
+#define _pcrexx_memory_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file memory.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "traits.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Source of memory for PCRE and pcrexx allocations.
+     */
+    class memory_resource
+    {
+        /* construction. */
+    public:
+        virtual ~memory_resource ()
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Allocate @a size bytes, aligned for any type.
+         * @throw std::bad_alloc Out of memory.
+         */
+        virtual void * allocate ( std::size_t size ) = 0;
+
+        /*!
+         * @brief Release @a size bytes at @a data, from @c allocate().
+         */
+        virtual void deallocate ( void * data, std::size_t size ) = 0;
+    };
+
+    /*!
+     * @brief Allocates from the general-purpose heap.
+     */
+    class heap_resource :
+        public memory_resource
+    {
+        /* class methods. */
+    public:
+        static heap_resource& instance ()
+        {
+            static heap_resource instance;
+            return (instance);
+        }
+
+        /* overrides. */
+    public:
+        virtual void * allocate ( std::size_t size )
+        {
+            void *const data = std::malloc((size > 0)? size : 1);
+            if (data == 0) {
+                throw (std::bad_alloc());
+            }
+            return (data);
+        }
+
+        virtual void deallocate ( void * data, std::size_t )
+        {
+            std::free(data);
+        }
+    };
+
+    /*!
+     * @brief Bump allocator for request-scoped matching.
+     *
+     * Allocations are carved out of large blocks and never freed
+     * individually: all memory is reclaimed at once by @c reset() (or when
+     * the arena is destroyed), so everything allocated from the arena must
+     * be released (or abandoned) by then.
+     *
+     * @code
+     *  pcrexx::bump_arena arena;
+     *  for (each request) {
+     *      pcrexx::memory_scope scope(arena);
+     *      // compile and match...
+     *      arena.reset();
+     *  }
+     * @endcode
+     *
+     * @note Arenas are not thread-safe: use one per thread.
+     */
+    class bump_arena :
+        public memory_resource
+    {
+        // Not copyable.
+        bump_arena ( const bump_arena& );
+        bump_arena& operator= ( const bump_arena& );
+
+        /* nested types. */
+    private:
+        struct block
+        {
+            block * next;
+            std::size_t size;
+        };
+
+        /* class data. */
+    private:
+        static const std::size_t ourAlignment = 16;
+
+        /* class methods. */
+    private:
+        static std::size_t align ( std::size_t size )
+        {
+            return ((size+ourAlignment-1) & ~(ourAlignment-1));
+        }
+
+        /* data. */
+    private:
+        memory_resource& myUpstream;
+        std::size_t myBlockSize;
+        block * myBlocks;
+        char * myCursor;
+        char * myLimit;
+        std::size_t myUsed;
+
+        /* construction. */
+    public:
+        /*!
+         * @param block_size Size of blocks requested from @a upstream.
+         *  Larger allocations get a block of their own.
+         */
+        explicit bump_arena ( std::size_t block_size=64*1024,
+                              memory_resource& upstream=
+                                  heap_resource::instance() )
+            : myUpstream(upstream), myBlockSize(block_size),
+              myBlocks(0), myCursor(0), myLimit(0), myUsed(0)
+        {}
+
+        virtual ~bump_arena ()
+        {
+            release();
+        }
+
+        /* methods. */
+    private:
+        void grow ( std::size_t size )
+        {
+            const std::size_t header = align(sizeof(block));
+            const std::size_t total =
+                header + ((size > myBlockSize)? size : myBlockSize);
+            block *const head =
+                static_cast<block*>(myUpstream.allocate(total));
+            head->next = myBlocks, head->size = total;
+            myBlocks = head;
+            myCursor = reinterpret_cast<char*>(head)+header;
+            myLimit = reinterpret_cast<char*>(head)+total;
+        }
+
+        void release ()
+        {
+            while (myBlocks != 0)
+            {
+                block *const next = myBlocks->next;
+                myUpstream.deallocate(myBlocks, myBlocks->size);
+                myBlocks = next;
+            }
+            myCursor = myLimit = 0;
+        }
+
+    public:
+        /*!
+         * @brief Bytes handed out since the last reset.
+         */
+        std::size_t used () const
+        {
+            return (myUsed);
+        }
+
+        /*!
+         * @brief Bytes obtained from the upstream resource.
+         */
+        std::size_t capacity () const
+        {
+            std::size_t total = 0;
+            for (const block * item = myBlocks; item; item = item->next) {
+                total += item->size;
+            }
+            return (total);
+        }
+
+        /*!
+         * @brief Reclaim all allocations.
+         *
+         * Memory is kept for reuse.  When it spans several blocks, they are
+         * merged into one, so a steady workload settles on a single block.
+         */
+        void reset ()
+        {
+            if ((myBlocks != 0) && (myBlocks->next != 0))
+            {
+                const std::size_t total = capacity();
+                release();
+                grow(total);
+            }
+            else if (myBlocks != 0) {
+                myCursor = reinterpret_cast<char*>(myBlocks) +
+                    align(sizeof(block));
+            }
+            myUsed = 0;
+        }
+
+        /* overrides. */
+    public:
+        virtual void * allocate ( std::size_t size )
+        {
+            size = align((size > 0)? size : 1);
+            if (std::size_t(myLimit-myCursor) < size) {
+                grow(size);
+            }
+            void *const data = myCursor;
+            myCursor += size, myUsed += size;
+            return (data);
+        }
+
+        virtual void deallocate ( void *, std::size_t )
+        {
+        }
+    };
+
+    /*!
+     * @brief Selects the memory resource used by the current thread.
+     *
+     * While the scope is alive, PCRE (see @c route_allocations()) and
+     * containers using @c scoped_allocator allocate from the resource.
+     * Scopes nest: the previous resource is restored when the scope ends.
+     * Without a scope, memory comes from the heap.
+     */
+    class memory_scope
+    {
+        // Not copyable.
+        memory_scope ( const memory_scope& );
+        memory_scope& operator= ( const memory_scope& );
+
+        /* class methods. */
+    private:
+        static memory_resource *& local ()
+        {
+            static thread_local memory_resource * instance = 0;
+            return (instance);
+        }
+
+    public:
+        /*!
+         * @brief Resource in use by the current thread.
+         */
+        static memory_resource& resource ()
+        {
+            memory_resource *const current = local();
+            if (current == 0) {
+                return (heap_resource::instance());
+            }
+            return (*current);
+        }
+
+        /* data. */
+    private:
+        memory_resource * myPrevious;
+
+        /* construction. */
+    public:
+        explicit memory_scope ( memory_resource& resource )
+            : myPrevious(local())
+        {
+            local() = &resource;
+        }
+
+        ~memory_scope ()
+        {
+            local() = myPrevious;
+        }
+    };
+
+    /*!
+     * @brief Standard allocator drawing from the current @c memory_scope.
+     *
+     * The resource is selected when the allocator (usually, the container)
+     * is constructed, including copies of containers, so results copied out
+     * of a request scope don't refer to its arena.  Use it for the string
+     * type of patterns and matches to control where extracted groups live:
+     * @code
+     *  typedef std::basic_string<char, std::char_traits<char>,
+     *      pcrexx::scoped_allocator<char> > string;
+     *  typedef pcrexx::basic_pattern<char, string> pattern;
+     * @endcode
+     */
+    template<class T>
+    class scoped_allocator
+    {
+        /* nested types. */
+    public:
+        typedef T value_type;
+        typedef T * pointer;
+        typedef const T * const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template<class U> struct rebind
+        {
+            typedef scoped_allocator<U> other;
+        };
+
+        /* data. */
+    private:
+        memory_resource * myResource;
+
+        /* construction. */
+    public:
+        scoped_allocator ()
+            : myResource(&memory_scope::resource())
+        {}
+
+        template<class U>
+        scoped_allocator ( const scoped_allocator<U>& other )
+            : myResource(other.resource())
+        {}
+
+        /* methods. */
+    public:
+        memory_resource * resource () const
+        {
+            return (myResource);
+        }
+
+        T * allocate ( std::size_t count )
+        {
+            return (static_cast<T*>(myResource->allocate(count*sizeof(T))));
+        }
+
+        void deallocate ( T * data, std::size_t count )
+        {
+            myResource->deallocate(data, count*sizeof(T));
+        }
+
+        scoped_allocator select_on_container_copy_construction () const
+        {
+            return (scoped_allocator());
+        }
+    };
+
+    template<class T, class U>
+    bool operator== ( const scoped_allocator<T>& lhs,
+                      const scoped_allocator<U>& rhs )
+    {
+        return (lhs.resource() == rhs.resource());
+    }
+
+    template<class T, class U>
+    bool operator!= ( const scoped_allocator<T>& lhs,
+                      const scoped_allocator<U>& rhs )
+    {
+        return (lhs.resource() != rhs.resource());
+    }
+
+    namespace detail {
+
+        // PCRE frees blocks without their size, and maybe in another
+        // scope, so each block records where it came from.
+        struct pcre_block
+        {
+            memory_resource * resource;
+            std::size_t size;
+        };
+
+        const std::size_t pcre_header = 16;
+
+        inline void * pcre_allocate ( std::size_t size )
+        {
+            try {
+                memory_resource& resource = memory_scope::resource();
+                char *const data = static_cast<char*>
+                    (resource.allocate(pcre_header+size));
+                pcre_block *const header = reinterpret_cast<pcre_block*>(data);
+                header->resource = &resource, header->size = pcre_header+size;
+                return (data+pcre_header);
+            }
+            catch (...) {
+                return (0);
+            }
+        }
+
+        inline void pcre_deallocate ( void * data )
+        {
+            if (data == 0) {
+                return;
+            }
+            char *const base = static_cast<char*>(data)-pcre_header;
+            const pcre_block *const header =
+                reinterpret_cast<const pcre_block*>(base);
+            header->resource->deallocate(base, header->size);
+        }
+
+    }
+
+    /*!
+     * @brief Route allocations made by the PCRE library for @a C through
+     *  the current @c memory_scope.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * This covers compiled patterns, study data and (for builds of PCRE
+     * that don't recurse on the machine stack) match-time frames.  The
+     * hooks are global, so call this once at startup, before compiling any
+     * pattern: memory allocated earlier can't be released through them.
+     *
+     * @note Compiled patterns allocated from an arena become invalid when
+     *  the arena is reset.  Patterns that outlive a request should be
+     *  compiled outside of its scope.
+     */
+    template<class C>
+    void route_allocations ()
+    {
+        traits<C>::set_allocator(&detail::pcre_allocate,
+                                 &detail::pcre_deallocate);
+    }
+
+}
+
+#endif /* _pcrexx_memory_hpp__ */
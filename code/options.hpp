@@ -91,6 +91,12 @@ namespace pcrexx {
             myMask |= PCRE_NO_AUTO_CAPTURE; return(*this);
         }
 
+        compile_options& raw_bytes () {
+            // Treat subjects as arbitrary code units (e.g. binary data), even
+            // if the pattern starts with (*UTF8) or similar.
+            myMask |= PCRE_NEVER_UTF; return(*this);
+        }
+
         compile_options& unicode_no_check () {
             // Note: PCRE_NO_UTF8_CHECK==PCRE_NO_UTF16_CHECK.
             myMask |= PCRE_NO_UTF8_CHECK; return(*this);
@@ -137,11 +143,13 @@ namespace pcrexx {
         /* data. */
     private:
         int myMask;
+        unsigned long myMatchLimit;
+        unsigned long myRecursionLimit;
 
         /* construction. */
     public:
         runtime_options ()
-            : myMask(0)
+            : myMask(0), myMatchLimit(0), myRecursionLimit(0)
         {}
 
         /* methods. */
@@ -206,6 +214,157 @@ namespace pcrexx {
             myMask |= PCRE_NOTEMPTY_ATSTART; return(*this);
         }
 
+        /*!
+         * @brief Don't check that UTF subjects are valid.
+         *
+         * PCRE checks the entire subject on every call, which is wasted
+         * work when searching the same subject again from another offset.
+         * The subject must be valid and the offset must be at the start of
+         * a character, or the behavior is undefined.
+         */
+        runtime_options& no_utf_check () {
+            // Note: PCRE_NO_UTF8_CHECK==PCRE_NO_UTF16_CHECK.
+            myMask |= PCRE_NO_UTF8_CHECK; return(*this);
+        }
+
+        // DFA matching only, see "dfa.hpp".
+        runtime_options& dfa_shortest () {
+            myMask |= PCRE_DFA_SHORTEST; return(*this);
+        }
+
+        // DFA matching only, see "dfa.hpp".
+        runtime_options& dfa_restart () {
+            myMask |= PCRE_DFA_RESTART; return(*this);
+        }
+
+        /*!
+         * @brief Abort the match after @a limit calls to the internal
+         *  matching function, overriding the pattern's limit.
+         *
+         * This bounds the time spent on patterns that backtrack a lot.
+         * Matches that hit the limit throw @c limit_exception.
+         */
+        runtime_options& match_limit ( unsigned long limit ) {
+            myMatchLimit = limit; return(*this);
+        }
+
+        /*!
+         * @brief Abort the match when recursion gets deeper than @a limit,
+         *  overriding the pattern's limit.
+         *
+         * This bounds the (stack) memory used by the match.  Matches that
+         * hit the limit throw @c limit_exception.
+         */
+        runtime_options& recursion_limit ( unsigned long limit ) {
+            myRecursionLimit = limit; return(*this);
+        }
+
+        unsigned long match_limit () const
+        {
+            return (myMatchLimit);
+        }
+
+        unsigned long recursion_limit () const
+        {
+            return (myRecursionLimit);
+        }
+
+        /* operators. */
+    public:
+        operator int () const
+        {
+            return (myMask);
+        }
+    };
+
+    /*!
+     * @brief Options for the (optional) study phase after compilation.
+     *
+     * By default, patterns are not studied.  Requesting any of the options
+     * below enables the study phase, which may speed up matching at the
+     * expense of extra work when the pattern is compiled.
+     *
+     * The match and recursion limits stored with the study data are set
+     * here too, and apply to all matches unless overridden by @c
+     * runtime_options.  They don't enable the study phase, and neither
+     * does the choice of matching algorithm.
+     */
+    class study_options
+    {
+        /* data. */
+    private:
+        bool myEnabled;
+        bool myDfa;
+        int myMask;
+        unsigned long myMatchLimit;
+        unsigned long myRecursionLimit;
+
+        /* construction. */
+    public:
+        study_options ()
+            : myEnabled(false), myDfa(false), myMask(0),
+              myMatchLimit(0), myRecursionLimit(0)
+        {}
+
+        /* methods. */
+    public:
+        study_options& optimize () {
+            myEnabled = true; return(*this);
+        }
+
+        study_options& jit () {
+            myEnabled = true; myMask |= PCRE_STUDY_JIT_COMPILE; return(*this);
+        }
+
+        study_options& jit_partial_soft () {
+            myEnabled = true;
+            myMask |= PCRE_STUDY_JIT_PARTIAL_SOFT_COMPILE; return(*this);
+        }
+
+        study_options& jit_partial_hard () {
+            myEnabled = true;
+            myMask |= PCRE_STUDY_JIT_PARTIAL_HARD_COMPILE; return(*this);
+        }
+
+        study_options& match_limit ( unsigned long limit ) {
+            myMatchLimit = limit; return(*this);
+        }
+
+        study_options& recursion_limit ( unsigned long limit ) {
+            myRecursionLimit = limit; return(*this);
+        }
+
+        /*!
+         * @brief Match with the alternative (DFA) algorithm by default.
+         *
+         * Matches then report the longest match at the first position
+         * where the pattern matches, and no capturing groups.  See
+         * "dfa.hpp" to get all matches at that position.
+         */
+        study_options& dfa () {
+            myDfa = true; return(*this);
+        }
+
+        bool enabled () const
+        {
+            return (myEnabled);
+        }
+
+        bool use_dfa () const
+        {
+            return (myDfa);
+        }
+
+        unsigned long match_limit () const
+        {
+            return (myMatchLimit);
+        }
+
+        unsigned long recursion_limit () const
+        {
+            return (myRecursionLimit);
+        }
+
         /* operators. */
     public:
         operator int () const
@@ -0,0 +1,216 @@
+#ifndef _pcrexx_parallel_hpp__
+#define _pcrexx_parallel_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file parallel.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "match_list.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "search.hpp"
+#include "thread_pool.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Report the first match in each line of a buffer, searching
+     *  parts of the buffer in parallel.
+     * @param chunk Approximate number of characters searched by each item
+     *  of work.  Parts are extended to end on a line boundary.
+     *
+     * Same as @c search_lines(), and matches are reported in the same
+     * order, from the calling thread.  The pattern is shared by all
+     * threads.
+     */
+    template<class C, class S, class Callback>
+    void parallel_search_lines ( thread_pool& pool,
+                                 const basic_pattern<C,S>& pattern,
+                                 const C * data, std::size_t size,
+                                 Callback callback,
+                                 runtime_options options=runtime_options(),
+                                 std::size_t chunk=1024*1024 )
+    {
+        typedef std::char_traits<C> char_traits;
+        // Cut the buffer after line feeds.
+        std::vector<std::size_t> cuts(1, 0);
+        while (cuts.back() < size)
+        {
+            std::size_t cut = cuts.back() + std::max<std::size_t>(chunk, 1);
+            if (cut < size)
+            {
+                const C * next = char_traits::find
+                    (data+cut, size-cut, C('\n'));
+                cut = (next == 0)? size : (next-data)+1;
+            }
+            cuts.push_back(std::min(cut, size));
+        }
+        std::vector< basic_match_list<C> > matches(cuts.size()-1);
+        pool.run(matches.size(), [&] ( std::size_t i )
+        {
+            basic_match_list<C>& list = matches[i];
+            const std::size_t offset = cuts[i];
+            search_lines(pattern, data+offset, cuts[i+1]-offset,
+                [&list, offset] ( const basic_match_view<C>& match,
+                                  std::size_t base )
+                {
+                    list.push(match, offset+base);
+                }, options);
+        });
+        for (std::size_t i=0; (i < matches.size()); ++i)
+        {
+            const basic_match_list<C>& list = matches[i];
+            for (std::size_t j=0; (j < list.size()); ++j) {
+                callback(list[j], list.base(j));
+            }
+        }
+    }
+
+    /*!
+     * @brief Report all non-overlapping matches in a buffer, searching
+     *  parts of the buffer in parallel.
+     * @param chunk Number of code units searched by each item of work.
+     *  For UTF patterns, parts are moved back to start on a character.
+     *
+     * Same as @c search_buffer(), and matches are reported in the same
+     * order, from the calling thread.  The pattern is shared by all
+     * threads.
+     *
+     * Each part is searched for matches that start inside it, as if the
+     * previous part had no matches.  When a match actually extends into
+     * the next part, the calling thread searches from its end until it
+     * finds a match that the next part also found, then reuses the rest of
+     * that part's results.
+     *
+     * Anchored searches (through @a options or the pattern itself, e.g.
+     * @c \\G) only match where the previous match ended, so they can't
+     * be split and are searched sequentially.
+     */
+    template<class C, class S, class Callback>
+    void parallel_search_buffer ( thread_pool& pool,
+                                  const basic_pattern<C,S>& pattern,
+                                  const C * data, std::size_t size,
+                                  Callback callback,
+                                  runtime_options options=runtime_options(),
+                                  std::size_t chunk=1024*1024 )
+    {
+        typedef basic_match_view<C> match_type;
+        const int anchored =
+            (int(options) | pattern.compiled_options()) & PCRE_ANCHORED;
+        if ((size == 0) || (anchored != 0)) {
+            search_buffer(pattern, data, size, callback, options); return;
+        }
+        chunk = std::max<std::size_t>(chunk, 1);
+        const std::size_t parts = (size+chunk-1) / chunk;
+        const std::size_t stride = (1+pattern.capturing_groups())*3;
+        // Note: the last part includes the (empty) end of the buffer.
+        std::vector<std::size_t> cuts(parts+1, 0);
+        const bool unicode = ((pattern.compiled_options() & PCRE_UTF8) != 0);
+        for (std::size_t i=0; (i < parts); ++i)
+        {
+            cuts[i] = i*chunk;
+            if (unicode) {
+                cuts[i] = detail::char_start(data, size, cuts[i]);
+            }
+        }
+        cuts[parts] = size+1;
+        std::vector< basic_match_list<C> > matches(parts);
+        pool.run(parts, [&] ( std::size_t i )
+        {
+            basic_match_list<C>& list = matches[i];
+            std::vector<int> results(stride, 0);
+            std::size_t from = cuts[i];
+            bool not_empty = false;
+            const std::function<bool(const match_type&,std::size_t)> sink =
+                [&list] ( const match_type& match, std::size_t base )
+            {
+                list.push(match, base); return (true);
+            };
+            search_range(pattern, data, size, from, not_empty,
+                         cuts[i+1], sink, options, results);
+        });
+        // Merge results in order, keeping track of where a sequential
+        // search would be.
+        std::vector<int> results(stride, 0);
+        std::size_t from = 0;
+        bool not_empty = false;
+        for (std::size_t i=0; (i < parts); ++i)
+        {
+            const basic_match_list<C>& list = matches[i];
+            const std::size_t start = cuts[i];
+            std::size_t j = 0;
+            if ((from > start) || ((from == start) && not_empty))
+            {
+                // Search until we find a match that this part also found.
+                bool synced = false;
+                const std::function<bool(const match_type&,std::size_t)> sink
+                    = [&] ( const match_type& match, std::size_t base )
+                {
+                    const std::size_t first = base+match.group_base();
+                    const std::size_t last = first+match.group_size();
+                    while ((j < list.size()) && (list.start(j) < first)) {
+                        ++j;
+                    }
+                    for (std::size_t k=j; (k < list.size()) &&
+                             (list.start(k) == first); ++k)
+                    {
+                        if (list.end(k) == last) {
+                            j = k, synced = true; return (false);
+                        }
+                    }
+                    callback(match, base); return (true);
+                };
+                search_range(pattern, data, size, from, not_empty,
+                             cuts[i+1], sink, options, results);
+                if (!synced) {
+                    continue;
+                }
+            }
+            for (; (j < list.size()); ++j)
+            {
+                callback(list[j], list.base(j));
+                from = list.end(j);
+                not_empty = (list.start(j) == list.end(j));
+            }
+        }
+    }
+
+}
+
+#endif /* _pcrexx_parallel_hpp__ */
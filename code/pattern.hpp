@@ -34,48 +34,109 @@
 
 #include <pcre.h>
 #include "exception.hpp"
+#include "jit.hpp"
+#include "literal.hpp"
 #include "options.hpp"
+#include "statistics.hpp"
+#include "string_ref.hpp"
 #include "traits.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace pcrexx {
 
     template<class C, class S> class basic_match;
+    template<class C> class basic_match_view;
+    template<class C, class S> class basic_match_range;
+    template<class C> class basic_replacement;
+    template<class C, class S> class basic_split_range;
+
+    namespace detail {
+
+        // PCRE rejects null subjects, even when empty, so pass it an empty
+        // string instead.
+        template<class C>
+        const C * subject ( const C * data )
+        {
+            static const C empty[1] = { C() };
+            return ((data == 0)? empty : data);
+        }
+
+    }
 
     /*!
      * @brief Compiled regular expression object.
      * @tparam C Character type.  @c traits<C> must be defined.  By default,
-     *  it is only @c traits<char> and @c traits<wchar_t> are provided.
+     *  @c traits<char>, @c traits<wchar_t>, @c traits<char16_t> and @c
+     *  traits<char32_t> are provided.
      * @tparam S String type.  Must have a default constructor, copy
      *  constructor, copy-assignment operator and a constructor that accepts
      *  a C-style null-terminated string with @c C as character type.  It must
      *  also have a @c c_str() member function that returns a C-style
      *  null-terminated string.
      *
-     * @note Pattern objects are immutable and thread-safe.
+     * @note Pattern objects are immutable and thread-safe.  Copies share
+     *  the compiled pattern (and study data), which is released with the
+     *  last copy, so patterns are cheap to copy and to store by value.
      */
     template<class C, class S=typename traits<C>::string>
     class basic_pattern
     {
-        // Not copyable.
-        basic_pattern ( const basic_pattern& );
-        basic_pattern& operator= ( const basic_pattern& );
-
         /* nested types. */
     public:
         typedef C char_type;
         typedef traits<char_type> traits_type;
 
         typedef typename traits_type::handle handle_type;
+        typedef typename traits_type::extra extra_type;
 
         typedef S string_type;
 
     private:
         typedef basic_pattern<C,S> self_type;
         typedef typename traits_type::const_char_ptr const_char_ptr;
+        typedef basic_string_ref<char_type> name_type;
+        typedef std::pair<string_type,int> name_entry;
+
+        // Releases the compiled pattern and study data when the last
+        // pattern that refers to them goes away.
+        struct owner
+        {
+            handle_type handle;
+            typename traits_type::study_handle extra;
+
+            owner ()
+                : handle(0), extra(0)
+            {}
+
+            ~owner ()
+            {
+                if (extra != 0) {
+                    traits_type::free_study(extra);
+                }
+                if (handle != 0) {
+                    traits_type::release(handle);
+                }
+            }
+        };
 
         /* class methods. */
     private:
+        static bool entry_less ( const name_entry& lhs, const name_entry& rhs )
+        {
+            return (name_type(lhs.first.c_str()) <
+                    name_type(rhs.first.c_str()));
+        }
+
+        static bool name_less ( const string_type& lhs, const name_type& rhs )
+        {
+            return (name_type(lhs.c_str()) < rhs);
+        }
+
         static const_char_ptr name_table ( handle_type pattern )
         {
             const_char_ptr table = 0;
@@ -98,10 +159,92 @@ namespace pcrexx {
             return (stride);
         }
 
+        static int name_count ( handle_type pattern )
+        {
+            int count = 0;
+            const int status = traits_type::query
+                (pattern, 0, PCRE_INFO_NAMECOUNT, &count);
+            if (status != 0) {
+                throw (exception(status, "name_count()"));
+            }
+            return (count);
+        }
+
+        static int compile_flags ( handle_type pattern )
+        {
+            unsigned long flags = 0;
+            const int status = traits_type::query
+                (pattern, 0, PCRE_INFO_OPTIONS, &flags);
+            if (status != 0) {
+                throw (exception(status, "compile_flags()"));
+            }
+            return (static_cast<int>(flags));
+        }
+
+        static int max_lookbehind ( handle_type pattern )
+        {
+            int length = 0;
+            const int status = traits_type::query
+                (pattern, 0, PCRE_INFO_MAXLOOKBEHIND, &length);
+            if (status != 0) {
+                throw (exception(status, "lookbehind()"));
+            }
+            return (length);
+        }
+
+        static std::size_t info_size ( handle_type pattern, extra_type extra,
+                                       int what )
+        {
+            std::size_t size = 0;
+            const int status = traits_type::query(pattern, extra, what, &size);
+            if (status != 0) {
+                throw (exception(status, "info_size()"));
+            }
+            return (size);
+        }
+
+        static int capture_count ( handle_type pattern )
+        {
+            int groups = 0;
+            const int status = traits_type::query
+                (pattern, 0, PCRE_INFO_CAPTURECOUNT, &groups);
+            if (status != 0) {
+                throw (exception(status, "capturing_groups()"));
+            }
+            return (groups);
+        }
+
         /* data. */
     private:
         string_type myText;
         handle_type myHandle;
+        typename traits_type::study_handle myExtra;
+
+        // Patterns loaded from precompiled data don't own their handle,
+        // nor their study data unless they were studied again.  Study data
+        // that isn't owned (or only holds limits) is kept here, and copied
+        // along with the pattern.
+        std::shared_ptr<owner> myOwner;
+        typename traits_type::study_data myStudyData;
+
+        // Metadata, cached at compile time.  Names are sorted, which
+        // allows binary search for group indices.  Literals are used to
+        // skip text that cannot match.
+        int myFlags;
+        bool myDfa;
+        int myLookbehind;
+        int myGroups;
+        std::vector<string_type> myNames;
+        std::vector<int> myIndices;
+        basic_literals<C> myLiterals;
+
+        // Number of matches aborted by the match or recursion limits.
+        mutable std::atomic<unsigned long> myMatchLimitTrips;
+        mutable std::atomic<unsigned long> myRecursionLimitTrips;
+
+#ifdef PCREXX_STATISTICS
+        mutable pattern_statistics myStatistics;
+#endif
 
         /* construction. */
     public:
@@ -109,22 +252,198 @@ namespace pcrexx {
          * @brief Compile a regular expression.
          */
         basic_pattern ( const string_type& text,
-                        compile_options options=compile_options() )
-            : myText(text), myHandle(0)
+                        compile_options options=compile_options(),
+                        study_options study=study_options() )
+            : myText(text), myHandle(0), myExtra(0),
+              myOwner(std::make_shared<owner>()), myStudyData(),
+              myFlags(0), myDfa(study.use_dfa()), myLookbehind(0),
+              myGroups(0), myMatchLimitTrips(0), myRecursionLimitTrips(0)
         {
             int error = 0;
             int offset = 0;
             const char * help = 0;
-            myHandle = traits_type::compile
+            myHandle = myOwner->handle = traits_type::compile
                 (myText.c_str(), options, &error, &help, &offset, 0);
             if (myHandle == 0) {
                 throw (exception(error, help));
             }
+            if (study.enabled()) {
+                study_pattern(study);
+            }
+            set_limits(study);
+            cache_metadata();
+        }
+
+        /*!
+         * @brief Use a pattern compiled earlier, see "bundle.hpp".
+         * @param compiled Compiled pattern, @c compiled_size() bytes.
+         * @param studied Study data, @c study_size() bytes, or null.
+         * @param study If enabled, study the pattern again (e.g. to
+         *  compile it to machine code) instead of using @a studied.
+         *
+         * The compiled pattern and study data are not copied and must
+         * outlive the pattern object.  They must come from the same version
+         * of PCRE, on a machine with the same byte order.
+         */
+        basic_pattern ( const string_type& text,
+                        const void * compiled, const void * studied,
+                        study_options study=study_options() )
+            : myText(text), myHandle(traits_type::load(compiled)), myExtra(0),
+              myOwner(std::make_shared<owner>()), myStudyData(),
+              myFlags(0), myDfa(study.use_dfa()), myLookbehind(0),
+              myGroups(0), myMatchLimitTrips(0), myRecursionLimitTrips(0)
+        {
+            if (study.enabled()) {
+                study_pattern(study);
+            }
+            else if (studied != 0) {
+                myStudyData.flags = PCRE_EXTRA_STUDY_DATA;
+                myStudyData.study_data = const_cast<void*>(studied);
+                myExtra = &myStudyData;
+            }
+            set_limits(study);
+            cache_metadata();
+        }
+
+        /*!
+         * @brief Share the compiled pattern of @a other.
+         *
+         * Counters (limit trips, statistics) start from zero.
+         */
+        basic_pattern ( const basic_pattern& other )
+            : myText(other.myText), myHandle(other.myHandle),
+              myExtra(other.myExtra), myOwner(other.myOwner),
+              myStudyData(other.myStudyData),
+              myFlags(other.myFlags), myDfa(other.myDfa),
+              myLookbehind(other.myLookbehind),
+              myGroups(other.myGroups),
+              myNames(other.myNames), myIndices(other.myIndices),
+              myLiterals(other.myLiterals),
+              myMatchLimitTrips(0), myRecursionLimitTrips(0)
+        {
+            rebind(other);
+        }
+
+        /*!
+         * @brief Take over the compiled pattern of @a other.
+         *
+         * Counters (limit trips, statistics) move along.  @a other may only
+         * be assigned to or destroyed afterwards.
+         */
+        basic_pattern ( basic_pattern&& other )
+            : myText(std::move(other.myText)), myHandle(other.myHandle),
+              myExtra(other.myExtra), myOwner(std::move(other.myOwner)),
+              myStudyData(other.myStudyData),
+              myFlags(other.myFlags), myDfa(other.myDfa),
+              myLookbehind(other.myLookbehind),
+              myGroups(other.myGroups),
+              myNames(std::move(other.myNames)),
+              myIndices(std::move(other.myIndices)),
+              myLiterals(std::move(other.myLiterals)),
+              myMatchLimitTrips(other.myMatchLimitTrips.load()),
+              myRecursionLimitTrips(other.myRecursionLimitTrips.load())
+        {
+            rebind(other);
+#ifdef PCREXX_STATISTICS
+            myStatistics.assign(other.myStatistics);
+#endif
+            other.myHandle = 0, other.myExtra = 0;
+        }
+
+    private:
+        // Point at our own copy of the study data, when not shared.
+        void rebind ( const basic_pattern& other )
+        {
+            if (other.myExtra == &other.myStudyData) {
+                myExtra = &myStudyData;
+            }
         }
 
-        ~basic_pattern ()
+        // Copy the plain members, for assignment.
+        void assign ( const basic_pattern& other )
         {
-            traits_type::release(myHandle);
+            myHandle = other.myHandle;
+            myExtra = other.myExtra;
+            myStudyData = other.myStudyData;
+            myFlags = other.myFlags;
+            myDfa = other.myDfa;
+            myLookbehind = other.myLookbehind;
+            myGroups = other.myGroups;
+            rebind(other);
+        }
+
+        void study_pattern ( study_options study )
+        {
+            // Note: a null result without an error message simply means
+            //       there was nothing to learn.
+            const char * help = 0;
+            myExtra = myOwner->extra =
+                traits_type::study(myHandle, study, &help);
+            if (help != 0) {
+                throw (exception(0, help));
+            }
+            // Run JIT code on per-thread stacks rather than the (small)
+            // default one, see "jit.hpp".
+            if (myExtra != 0) {
+                traits_type::assign_jit_stack
+                    (myExtra, &jit_stack_pool<C>::callback, 0);
+            }
+        }
+
+        void set_limits ( study_options study )
+        {
+            if ((study.match_limit() == 0) &&
+                (study.recursion_limit() == 0)) {
+                return;
+            }
+            // Limits are stored with the study data, so patterns that were
+            // not studied (or had nothing to learn) need their own.
+            if (myExtra == 0) {
+                myExtra = &myStudyData;
+            }
+            if (study.match_limit() != 0) {
+                myExtra->flags |= PCRE_EXTRA_MATCH_LIMIT;
+                myExtra->match_limit = study.match_limit();
+            }
+            if (study.recursion_limit() != 0) {
+                myExtra->flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+                myExtra->match_limit_recursion = study.recursion_limit();
+            }
+        }
+
+        void cache_metadata ()
+        {
+            myFlags = compile_flags(myHandle);
+            myLookbehind = max_lookbehind(myHandle);
+            myGroups = capture_count(myHandle);
+            myLiterals = basic_literals<C>(myHandle, myFlags, myText.c_str());
+            const int count = name_count(myHandle);
+            if (count == 0) {
+                return;
+            }
+            // Entries in the name table hold the group index followed by
+            // the null-terminated name.  PCRE already sorts them, but
+            // sort again so lookups never depend on how the string type
+            // orders them.
+            const_char_ptr table = name_table(myHandle);
+            const int stride = name_table_stride(myHandle);
+            std::vector<name_entry> entries;
+            entries.reserve(count);
+            for (int i=0; (i < count); ++i)
+            {
+                const_char_ptr entry = table + (i*stride);
+                entries.push_back(std::make_pair(
+                    string_type(entry+traits_type::table_offset()),
+                    traits_type::table_index(entry)));
+            }
+            std::sort(entries.begin(), entries.end(), &entry_less);
+            myNames.reserve(count);
+            myIndices.reserve(count);
+            for (int i=0; (i < count); ++i)
+            {
+                myNames.push_back(entries[i].first);
+                myIndices.push_back(entries[i].second);
+            }
         }
 
         /* methods. */
@@ -134,6 +453,267 @@ namespace pcrexx {
             return (myHandle);
         }
 
+        /*!
+         * @brief Data collected by the study phase, if any.
+         *
+         * This is null unless the pattern was compiled with study options
+         * or match limits.
+         */
+        extra_type extra () const
+        {
+            return (myExtra);
+        }
+
+        /*!
+         * @brief Match @a size characters at @a data, starting at @a base.
+         * @return PCRE's status code.  Errors are reported, not thrown.
+         *
+         * This applies the limits set in @a options and keeps track of
+         * how many matches hit them.  Other match objects are built on
+         * top of this.
+         *
+         * Patterns studied with @c study_options::dfa() use the DFA
+         * algorithm, and only report the longest match (as group 0).
+         */
+        int execute ( const char_type * data, int size, int base,
+                      runtime_options options, int * results, int count ) const
+        {
+            if (myDfa) {
+                return (execute_dfa(data, size, base, options,
+                                    results, count));
+            }
+            typename traits_type::study_data limited =
+                typename traits_type::study_data();
+            const extra_type extra = limit(options, limited);
+#ifdef PCREXX_STATISTICS
+            const pattern_statistics::clock_type::time_point start =
+                pattern_statistics::clock_type::now();
+#endif
+            const int status = traits_type::execute
+                (myHandle, extra, data, size, base, options, results, count);
+#ifdef PCREXX_STATISTICS
+            record(start, size, base, status, results, count);
+#endif
+            count_trips(status);
+            return (status);
+        }
+
+        /*!
+         * @brief Match using the alternative (DFA) algorithm.
+         * @return PCRE's status code.  Errors are reported, not thrown.
+         *
+         * Like @c execute(), this applies the limits set in @a options and
+         * keeps track of statistics.  See "dfa.hpp" for the results.
+         */
+        int dfa_execute ( const char_type * data, int size, int base,
+                          runtime_options options, int * results, int count,
+                          int * workspace, int workspace_size ) const
+        {
+            typename traits_type::study_data limited =
+                typename traits_type::study_data();
+            const extra_type extra = limit(options, limited);
+#ifdef PCREXX_STATISTICS
+            const pattern_statistics::clock_type::time_point start =
+                pattern_statistics::clock_type::now();
+#endif
+            const int status = traits_type::dfa_execute
+                (myHandle, extra, data, size, base, options,
+                 results, count, workspace, workspace_size);
+#ifdef PCREXX_STATISTICS
+            // Note: the caller retries with a larger workspace.
+            if (status != PCRE_ERROR_DFA_WSSIZE) {
+                record(start, size, base, status, results, count);
+            }
+#endif
+            count_trips(status);
+            return (status);
+        }
+
+    private:
+        // Study data with the limits set in @a options, if any.  Patterns
+        // are shared, so limits are overridden in a copy, @a limited.
+        extra_type limit ( runtime_options options,
+                           typename traits_type::study_data& limited ) const
+        {
+            if ((options.match_limit() == 0) &&
+                (options.recursion_limit() == 0)) {
+                return (myExtra);
+            }
+            if (myExtra != 0) {
+                limited = *myExtra;
+            }
+            if (options.match_limit() != 0) {
+                limited.flags |= PCRE_EXTRA_MATCH_LIMIT;
+                limited.match_limit = options.match_limit();
+            }
+            if (options.recursion_limit() != 0) {
+                limited.flags |= PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+                limited.match_limit_recursion = options.recursion_limit();
+            }
+            return (&limited);
+        }
+
+        // Matches for patterns studied with study_options::dfa().  The
+        // workspace is kept per thread, so partial DFA matches can't be
+        // resumed here (use a dfa_matcher instead).
+        int execute_dfa ( const char_type * data, int size, int base,
+                          runtime_options options,
+                          int * results, int count ) const
+        {
+            static thread_local std::vector<int> workspace(1000);
+            int status = 0;
+            while (true)
+            {
+                status = dfa_execute
+                    (data, size, base, options, results, count,
+                     &workspace[0], int(workspace.size()));
+                if ((status != PCRE_ERROR_DFA_WSSIZE) ||
+                    (workspace.size() >= 1024*1024)) {
+                    break;
+                }
+                workspace.resize(2*workspace.size());
+            }
+            if (status < 0) {
+                return (status);
+            }
+            // Keep the longest match, which comes first, and clear the
+            // other matches from where groups would be.
+            for (int i=2; (i < 2*(count/3)); ++i) {
+                results[i] = -1;
+            }
+            return (1);
+        }
+
+#ifdef PCREXX_STATISTICS
+        void record ( pattern_statistics::clock_type::time_point start,
+                      int size, int base, int status,
+                      const int * results, int count ) const
+        {
+            // Count the text consumed, so that searching the same subject
+            // again from where the last match ended counts it only once.
+            int end = base;
+            if ((status >= 0) && (count >= 2)) {
+                end = results[1];
+            }
+            else if ((status >= 0) || (status == PCRE_ERROR_NOMATCH) ||
+                     (status == PCRE_ERROR_PARTIAL)) {
+                end = size;
+            }
+            const std::size_t scanned = (base < end)? end-base : 0;
+            myStatistics.record(start, scanned*sizeof(char_type), status);
+        }
+#endif
+
+        void count_trips ( int status ) const
+        {
+            if (status == PCRE_ERROR_MATCHLIMIT) {
+                ++myMatchLimitTrips;
+            }
+            else if (status == PCRE_ERROR_RECURSIONLIMIT) {
+                ++myRecursionLimitTrips;
+            }
+        }
+
+    public:
+        /*!
+         * @brief Number of matches aborted by the match limit.
+         */
+        unsigned long match_limit_trips () const
+        {
+            return (myMatchLimitTrips.load());
+        }
+
+        /*!
+         * @brief Number of matches aborted by the recursion limit.
+         */
+        unsigned long recursion_limit_trips () const
+        {
+            return (myRecursionLimitTrips.load());
+        }
+
+#ifdef PCREXX_STATISTICS
+        /*!
+         * @brief Counters for all matches using this pattern.
+         *
+         * Only available when @c PCREXX_STATISTICS is defined, see
+         * "statistics.hpp".  Bytes scanned are counted from the start
+         * offset to the end of the match, or to the end of the subject
+         * when there is no match (or its position isn't reported).  Errors
+         * count no bytes.
+         */
+        statistics_snapshot statistics () const
+        {
+            return (myStatistics.snapshot());
+        }
+
+        /*!
+         * @brief Reset all counters returned by @c statistics().
+         */
+        void reset_statistics () const
+        {
+            myStatistics.reset();
+        }
+#endif
+
+        /*!
+         * @brief Size of the compiled pattern, in bytes.
+         *
+         * The compiled pattern can be saved and loaded later, see
+         * "bundle.hpp".
+         */
+        std::size_t compiled_size () const
+        {
+            return (info_size(myHandle, 0, PCRE_INFO_SIZE));
+        }
+
+        /*!
+         * @brief Size of the study data, in bytes (0 if not studied).
+         *
+         * Machine code generated by the JIT compiler is not included.
+         */
+        std::size_t study_size () const
+        {
+            if (study_data() == 0) {
+                return (0);
+            }
+            return (info_size(myHandle, myExtra, PCRE_INFO_STUDYSIZE));
+        }
+
+        /*!
+         * @brief Study data, or null if the pattern was not studied.
+         */
+        const void * study_data () const
+        {
+            if ((myExtra == 0) ||
+                ((myExtra->flags & PCRE_EXTRA_STUDY_DATA) == 0)) {
+                return (0);
+            }
+            return (myExtra->study_data);
+        }
+
+        /*!
+         * @brief Check if matching will use the JIT-compiled code.
+         */
+        bool jit_compiled () const
+        {
+            int compiled = 0;
+            const int status = traits_type::query
+                (myHandle, myExtra, PCRE_INFO_JIT, &compiled);
+            if (status != 0) {
+                throw (exception(status, "jit_compiled()"));
+            }
+            return (compiled != 0);
+        }
+
+        /*!
+         * @brief Check if matches use the alternative (DFA) algorithm by
+         *  default, see @c study_options::dfa().
+         */
+        bool dfa () const
+        {
+            return (myDfa);
+        }
+
         /*!
          * @brief Regular expression used to compile the pattern.
          */
@@ -142,60 +722,193 @@ namespace pcrexx {
             return (myText);
         }
 
+        /*!
+         * @brief Options in effect for the compiled pattern.
+         *
+         * This includes options set by the regular expression itself, such
+         * as @c (?i) and @c (*UTF8).
+         */
+        int compiled_options () const
+        {
+            return (myFlags);
+        }
+
+        /*!
+         * @brief Longest lookbehind assertion in the pattern, in characters.
+         *
+         * This is how much text before the start offset a match may look
+         * at, which matters when searching text piece by piece.
+         */
+        int lookbehind () const
+        {
+            return (myLookbehind);
+        }
+
+        /*!
+         * @brief Code units before the start offset that a search may need
+         *  to see, when searching text piece by piece.
+         *
+         * This covers lookbehind assertions, and at least 2 characters so
+         * that "^" in multiline mode and "\b" see what precedes the start.
+         */
+        int context_size () const
+        {
+            int length = std::max(myLookbehind, 2);
+            if ((myFlags & PCRE_UTF8) != 0) {
+                length *= traits_type::max_char_size();
+            }
+            return (length);
+        }
+
         /*!
          * @brief Obtain the number of capturing groups in the pattern.
          */
         int capturing_groups () const
         {
-            int groups = 0;
-            const int status = traits_type::query
-                (myHandle, 0, PCRE_INFO_CAPTURECOUNT, &groups);
-            if (status != 0) {
-                throw (exception(status, "capturing_groups()"));
-            }
-            return (groups);
+            return (myGroups);
         }
 
         /*!
          * @brief Obtain the index of a group using its name.
+         * @return The group index, or -1 if there is no such group.
          */
         int group_index ( const string_type& name ) const
         {
-            const int index =
-                traits_type::string_number(myHandle, name.c_str());
-            if (index == PCRE_ERROR_NOSUBSTRING) {
+            return (group_index(name.c_str()));
+        }
+
+        /*!
+         * @brief Obtain the index of a group using its name.
+         * @return The group index, or -1 if there is no such group.
+         *
+         * This overload does not allocate.
+         */
+        int group_index ( const char_type * name ) const
+        {
+            const name_type key(name);
+            const typename std::vector<string_type>::const_iterator match =
+                std::lower_bound(myNames.begin(), myNames.end(),
+                                 key, &name_less);
+            if ((match == myNames.end()) ||
+                (key < name_type(match->c_str()))) {
                 return (-1);
             }
-            if (index < 0) {
-                throw (exception(index, "capturing_groups()"));
-            }
-            return (index);
+            return (myIndices[match-myNames.begin()]);
         }
 
         /*!
-         * @brief Obtain the names of all capturing groups.
+         * @brief Obtain the names of all named capturing groups.
          *
          * The name of capturing groups are listed in alphabetical order.
          */
-        std::vector<string_type> group_names () const
+        const std::vector<string_type>& group_names () const
         {
-            // Access the name table.
-            const_char_ptr table = name_table(myHandle);
-            const int stride = name_table_stride(myHandle);
-            // Scan the table for names.
-            std::vector<string_type> names;
-            for (int i=0; (i < capturing_groups()); ++i) {
-                names.push_back(table+(i*stride)+traits_type::table_offset());
-            }
-            return (names);
+            return (myNames);
+        }
+
+        /*!
+         * @brief Literals that every match contains, found when the
+         *  pattern was compiled.
+         *
+         * These allow skipping text that cannot match without running
+         * PCRE, see "prefilter.hpp".
+         */
+        const basic_literals<C>& literals () const
+        {
+            return (myLiterals);
         }
 
         /* operators. */
     public:
+        basic_pattern& operator= ( const basic_pattern& other )
+        {
+            if (this != &other)
+            {
+                assign(other);
+                myOwner = other.myOwner;
+                myText = other.myText;
+                myNames = other.myNames;
+                myIndices = other.myIndices;
+                myLiterals = other.myLiterals;
+                myMatchLimitTrips = 0, myRecursionLimitTrips = 0;
+#ifdef PCREXX_STATISTICS
+                myStatistics.reset();
+#endif
+            }
+            return (*this);
+        }
+
+        basic_pattern& operator= ( basic_pattern&& other )
+        {
+            if (this != &other)
+            {
+                assign(other);
+                myOwner = std::move(other.myOwner);
+                myText = std::move(other.myText);
+                myNames = std::move(other.myNames);
+                myIndices = std::move(other.myIndices);
+                myLiterals = std::move(other.myLiterals);
+                myMatchLimitTrips = other.myMatchLimitTrips.load();
+                myRecursionLimitTrips = other.myRecursionLimitTrips.load();
+#ifdef PCREXX_STATISTICS
+                myStatistics.assign(other.myStatistics);
+#endif
+                other.myHandle = 0, other.myExtra = 0;
+            }
+            return (*this);
+        }
+
         // See "match.hpp".
         basic_match<C,S> operator() (
             const string_type& text,
             runtime_options options=runtime_options()) const;
+
+        basic_match<C,S> operator() (
+            string_type&& text,
+            runtime_options options=runtime_options()) const;
+
+        // See "match_view.hpp".
+        basic_match_view<C> operator() (
+            const char_type * data, int size, int * results, int count,
+            runtime_options options=runtime_options()) const;
+
+        // See "iterator.hpp".
+        basic_match_range<C,S> find_all (
+            const char_type * data, int size,
+            runtime_options options=runtime_options()) const;
+
+        // See "split.hpp".
+        basic_split_range<C,S> split (
+            const char_type * data, int size, int limit=0,
+            bool captures=false,
+            runtime_options options=runtime_options()) const;
+
+        // See "replace.hpp".
+        int replace_first (
+            const char_type * data, int size,
+            const basic_replacement<C>& replacement, string_type& output,
+            runtime_options options=runtime_options()) const;
+
+        int replace_all (
+            const char_type * data, int size,
+            const basic_replacement<C>& replacement, string_type& output,
+            runtime_options options=runtime_options()) const;
+
+        string_type replace_first (
+            const string_type& text, const basic_replacement<C>& replacement,
+            runtime_options options=runtime_options()) const;
+
+        string_type replace_all (
+            const string_type& text, const basic_replacement<C>& replacement,
+            runtime_options options=runtime_options()) const;
+
+        template<int N>
+        basic_match_view<C> operator() (
+            const char_type * data, int size, int (&results)[N],
+            runtime_options options=runtime_options()) const
+        {
+            return ((*this)(data, size, results, N, options));
+        }
     };
 
     /*!
@@ -204,10 +917,22 @@ namespace pcrexx {
     typedef basic_pattern<char> pattern;
 
     /*!
-     * @brief Regular expression for UTF-16 strings stored in @c std::wstring.
+     * @brief Regular expression for wide strings stored in @c std::wstring.
      */
     typedef basic_pattern<wchar_t> wpattern;
 
+    /*!
+     * @brief Regular expression for UTF-16 strings stored in @c
+     *  std::u16string.
+     */
+    typedef basic_pattern<char16_t> u16pattern;
+
+    /*!
+     * @brief Regular expression for UTF-32 strings stored in @c
+     *  std::u32string.
+     */
+    typedef basic_pattern<char32_t> u32pattern;
+
 }
 
 #endif /* _pcrexx_pattern_hpp__ */
@@ -0,0 +1,243 @@
+#ifndef _pcrexx_pattern_set_hpp__
+#define _pcrexx_pattern_set_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file pattern_set.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "literal.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Collection of patterns matched together against one subject.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * When a pattern is added, the set keeps the literals that must appear
+     * in any match: the longest run of literal code units, and the first
+     * and last required code units (see @c basic_literals).  Patterns that
+     * share a literal share its entry.  Matching scans the subject once
+     * for all distinct literals together (see @c basic_literal_scanner),
+     * and only runs the patterns whose literals were all found.  Patterns
+     * without literals are always run.
+     *
+     * Letters in literals reported by PCRE are compared without regard to
+     * case, since PCRE doesn't report whether they are caseless.  This may
+     * let extra patterns through the filter, but never hides a match.
+     *
+     * @note Patterns whose only literals are common characters still pass
+     *  the filter on most text, so the set pays off most when patterns
+     *  contain distinctive words.
+     *
+     * @note Pattern sets are thread-safe once all patterns are added.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_pattern_set
+    {
+        // Not copyable.
+        basic_pattern_set ( const basic_pattern_set& );
+        basic_pattern_set& operator= ( const basic_pattern_set& );
+
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef S string_type;
+        typedef basic_pattern<C,S> pattern_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+        typedef basic_literal<C> literal_type;
+
+        /* data. */
+    private:
+        compile_options myCompileOptions;
+        study_options myStudyOptions;
+        std::vector< std::unique_ptr<pattern_type> > myPatterns;
+
+        // Distinct literals, and the literals of each pattern (indices in
+        // myLiterals, from myFirstLiteral[i] to myFirstLiteral[i+1]).
+        basic_literal_scanner<C> myLiterals;
+        std::vector<std::size_t> myPatternLiterals;
+        std::vector<std::size_t> myFirstLiteral;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Build an empty set.
+         * @param options Options used to compile every pattern in the set.
+         * @param study Options used to study every pattern in the set.
+         */
+        explicit basic_pattern_set
+            ( compile_options options=compile_options(),
+              study_options study=study_options() )
+            : myCompileOptions(options), myStudyOptions(study),
+              myFirstLiteral(1, 0)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Compile a regular expression and add it to the set.
+         * @return The index of the pattern in the set.
+         */
+        std::size_t add ( const string_type& text )
+        {
+            std::unique_ptr<pattern_type> pattern
+                (new pattern_type(text, myCompileOptions, myStudyOptions));
+            const basic_literals<C>& literals = pattern->literals();
+            const literal_type * candidates[] = {
+                &literals.longest(), &literals.required(), &literals.first(),
+            };
+            myPatterns.reserve(myPatterns.size()+1);
+            myFirstLiteral.reserve(myFirstLiteral.size()+1);
+            myPatternLiterals.reserve(myPatternLiterals.size()+3);
+            // Note: literals added before an exception stay in the scanner,
+            // which only costs a little scanning.
+            std::size_t indices[3];
+            std::size_t count = 0;
+            for (std::size_t i=0; (i < 3); ++i)
+            {
+                if (!candidates[i]->empty()) {
+                    indices[count++] = myLiterals.add(*candidates[i]);
+                }
+            }
+            // Nothing below throws, given the storage reserved above.
+            myPatternLiterals.insert
+                (myPatternLiterals.end(), indices, indices+count);
+            myFirstLiteral.push_back(myPatternLiterals.size());
+            myPatterns.push_back(std::move(pattern));
+            return (myPatterns.size()-1);
+        }
+
+    private:
+        // Check if all literals of pattern @a i were found.
+        bool possible ( std::size_t i, const std::size_t * found ) const
+        {
+            for (std::size_t j=myFirstLiteral[i];
+                 (j < myFirstLiteral[i+1]); ++j)
+            {
+                if (found[myPatternLiterals[j]] != 1) {
+                    return (false);
+                }
+            }
+            return (true);
+        }
+
+    public:
+        /*!
+         * @brief Number of patterns in the set.
+         */
+        std::size_t size () const
+        {
+            return (myPatterns.size());
+        }
+
+        /*!
+         * @brief Access a pattern by its index in the set.
+         */
+        const pattern_type& operator[] ( std::size_t i ) const
+        {
+            return (*myPatterns[i]);
+        }
+
+        /*!
+         * @brief Find which patterns match @a data.
+         * @param matched Receives the indices of the patterns that match,
+         *  in increasing order.  Its previous contents are discarded.
+         *
+         * Reusing @a matched across calls avoids allocating once it has
+         * grown large enough.
+         */
+        void match ( const_char_ptr data, int size,
+                     std::vector<std::size_t>& matched,
+                     runtime_options options=runtime_options() ) const
+        {
+            // Keep which literals were found at the front of 'matched', so
+            // it needs no other storage.
+            const std::size_t literals = myLiterals.size();
+            matched.assign(literals, 0);
+            if (literals > 0) {
+                myLiterals.find(data, std::size_t(size), matched.data());
+            }
+            // Run patterns that passed the filter.
+            int results[3];
+            for (std::size_t i=0; (i < myPatterns.size()); ++i)
+            {
+                if (!possible(i, matched.data())) {
+                    continue;
+                }
+                const basic_match_view<C> match
+                    (*myPatterns[i], data, size, results, 3, options);
+                if (match) {
+                    matched.push_back(i);
+                }
+            }
+            matched.erase(matched.begin(), matched.begin()+literals);
+        }
+
+        /*!
+         * @brief Find which patterns match @a data.
+         * @return The indices of the patterns that match, in increasing
+         *  order.
+         */
+        std::vector<std::size_t> match
+            ( const_char_ptr data, int size,
+              runtime_options options=runtime_options() ) const
+        {
+            std::vector<std::size_t> matched;
+            match(data, size, matched, options);
+            return (matched);
+        }
+    };
+
+    /*!
+     * @brief Pattern set for UTF-8 strings stored in @c std::string.
+     */
+    typedef basic_pattern_set<char> pattern_set;
+
+    /*!
+     * @brief Pattern set for wide strings stored in @c std::wstring.
+     */
+    typedef basic_pattern_set<wchar_t> wpattern_set;
+
+}
+
+#endif /* _pcrexx_pattern_set_hpp__ */
@@ -27,7 +27,31 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include "batch.hpp"
+#include "bundle.hpp"
+#include "cache.hpp"
+#include "dfa.hpp"
+#include "iterator.hpp"
+#include "jit.hpp"
+#include "lazy_pattern.hpp"
+#include "literal.hpp"
+#include "mapped_file.hpp"
 #include "match.hpp"
+#include "match_list.hpp"
+#include "match_view.hpp"
+#include "memory.hpp"
+#include "parallel.hpp"
 #include "pattern.hpp"
+#include "pattern_set.hpp"
+#include "prefilter.hpp"
+#include "replace.hpp"
+#include "search.hpp"
+#include "split.hpp"
+#include "static_pattern.hpp"
+#include "statistics.hpp"
+#include "stream.hpp"
+#include "string_ref.hpp"
+#include "syntax.hpp"
+#include "thread_pool.hpp"
 
 #endif /* _pcrexx_hpp__ */
@@ -0,0 +1,174 @@
+#ifndef _pcrexx_prefilter_hpp__
+#define _pcrexx_prefilter_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file prefilter.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "literal.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <cstddef>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Skips text that cannot contain a match, without running PCRE.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * Uses the literals found when the pattern was compiled (see @c
+     * basic_literals): the code unit that starts every match, and the
+     * longest literal that every match contains (or the last required
+     * code unit).  Scanning for these with SSE2 (or memchr()) is much
+     * faster than letting PCRE try each position, especially when matches
+     * are sparse in large buffers.
+     *
+     * The first unit is ignored for anchored searches, and for patterns
+     * compiled with @c PCRE_NO_START_OPTIMIZE (whose results may depend on
+     * where matching starts).  Nothing is filtered for partial matching.
+     *
+     * The filter refers to the pattern's literals, so the pattern must
+     * outlive it.
+     *
+     * @see search_buffer()
+     */
+    template<class C>
+    class basic_prefilter
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+        typedef basic_literal<char_type> literal_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        const literal_type * myFirst;
+        const literal_type * myRequired;
+        const_char_ptr myRequiredAt;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Build a filter that lets all text through.
+         */
+        basic_prefilter ()
+            : myFirst(0), myRequired(0), myRequiredAt(0)
+        {}
+
+        template<class S>
+        explicit basic_prefilter ( const basic_pattern<C,S>& pattern,
+                                   runtime_options options=runtime_options() )
+            : myFirst(0), myRequired(0), myRequiredAt(0)
+        {
+            const int flags = pattern.compiled_options() | int(options);
+            if ((flags & (PCRE_PARTIAL_SOFT|PCRE_PARTIAL_HARD)) != 0) {
+                return;
+            }
+            // Longer literals are usually rarer than single units.
+            const basic_literals<C>& literals = pattern.literals();
+            myRequired =
+                (literals.longest().size() >= literals.required().size())?
+                &literals.longest() : &literals.required();
+            if (myRequired->empty()) {
+                myRequired = 0;
+            }
+            const int anchored =
+                PCRE_ANCHORED|PCRE_FIRSTLINE|PCRE_NO_START_OPTIMIZE;
+            if (((flags & anchored) == 0) && !literals.first().empty()) {
+                myFirst = &literals.first();
+            }
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Check if the filter can skip any text at all.
+         */
+        bool enabled () const
+        {
+            return ((myFirst != 0) || (myRequired != 0));
+        }
+
+        /*!
+         * @brief Find where the next match may start.
+         * @param base Offset at which matching would start.
+         * @return The first offset at or after @a base where a match may
+         *  start, or -1 if no match starts before @a size.
+         */
+        int next ( const_char_ptr data, int base, int size ) const
+        {
+            if (myFirst == 0) {
+                return (base);
+            }
+            const std::size_t offset =
+                myFirst->find(data+base, std::size_t(size-base));
+            return ((offset == std::size_t(size-base))? -1 : base+int(offset));
+        }
+
+        /*!
+         * @brief Check if text from @a base to @a size can contain a match.
+         *
+         * The position of the required literal is remembered, so calling
+         * this for increasing values of @a base over the same text rescans
+         * nothing until matching goes past it.  A stale position only
+         * lets text through, so reusing the filter for other text is safe.
+         */
+        bool possible ( const_char_ptr data, int base, int size )
+        {
+            if (myRequired == 0) {
+                return (true);
+            }
+            const int length = int(myRequired->size());
+            if ((myRequiredAt >= data+base) &&
+                (myRequiredAt+length <= data+size)) {
+                return (true);
+            }
+            const std::size_t offset =
+                myRequired->find(data+base, std::size_t(size-base));
+            if (offset == std::size_t(size-base)) {
+                myRequiredAt = 0; return (false);
+            }
+            myRequiredAt = data+base+offset;
+            return (true);
+        }
+    };
+
+    typedef basic_prefilter<char> prefilter;
+    typedef basic_prefilter<wchar_t> wprefilter;
+
+}
+
+#endif /* _pcrexx_prefilter_hpp__ */
@@ -0,0 +1,472 @@
+#ifndef _pcrexx_replace_hpp__
+#define _pcrexx_replace_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file replace.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "iterator.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Replacement text for matches of a pattern.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     *
+     * The replacement text is parsed once, when the replacement is built,
+     * into literal text and references to captured groups:
+     * - @c $n and @c ${n} insert group @a n (@c $0 is the entire match);
+     * - @c ${name} inserts the named group @a name;
+     * - @c $$ inserts a single @c $.
+     *
+     * Groups that did not participate in the match insert nothing.
+     *
+     * @code
+     *  const pcrexx::pattern pattern("(?<user>\\w+)@(\\w+)\\.com");
+     *  const pcrexx::replacement mask(pattern, "${user}@***.$2");
+     *  std::string output;
+     *  output.reserve(size);
+     *  pattern.replace_all(data, size, mask, output);
+     * @endcode
+     */
+    template<class C>
+    class basic_replacement
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef basic_match_view<char_type> match_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        // Literal text (group < 0) or reference to a group.
+        struct piece
+        {
+            int group;
+            int base;
+            int size;
+        };
+
+        /* class methods. */
+    private:
+        static bool is_digit ( char_type c )
+        {
+            return ((c >= char_type('0')) && (c <= char_type('9')));
+        }
+
+        static int parse_index ( const_char_ptr data, int size, int& i )
+        {
+            // PCRE allows at most 65535 groups: stop accumulating past that
+            // (without overflowing), so that the reference is rejected.
+            static const int limit = 65536;
+            int index = 0;
+            for (; (i < size) && is_digit(data[i]); ++i) {
+                const int digit = int(data[i]-char_type('0'));
+                index = std::min(10*index + digit, limit);
+            }
+            return (index);
+        }
+
+        /* data. */
+    private:
+        std::vector<char_type> myText;
+        std::vector<piece> myPieces;
+        int myGroups;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Parse @a size characters at @a text as the replacement for
+         *  matches of @a pattern.
+         * @throw exception Reference to a group that doesn't exist in @a
+         *  pattern, or @c $ not followed by a valid reference.
+         */
+        template<class S>
+        basic_replacement ( const basic_pattern<C,S>& pattern,
+                            const char_type * text, int size )
+            : myText(text, text+size), myPieces(), myGroups(0)
+        {
+            parse(pattern);
+        }
+
+        template<class S>
+        basic_replacement (
+            const basic_pattern<C,S>& pattern,
+            const typename basic_pattern<C,S>::string_type& text )
+            : myText(text.c_str(), text.c_str()+text.size()),
+              myPieces(), myGroups(0)
+        {
+            parse(pattern);
+        }
+
+    private:
+        void literal ( int base, int size )
+        {
+            if (size == 0) {
+                return;
+            }
+            // Merge with the preceding literal, when contiguous.
+            if (!myPieces.empty() && (myPieces.back().group < 0) &&
+                (myPieces.back().base+myPieces.back().size == base))
+            {
+                myPieces.back().size += size; return;
+            }
+            const piece entry = { -1, base, size };
+            myPieces.push_back(entry);
+        }
+
+        void reference ( int group )
+        {
+            const piece entry = { group, 0, 0 };
+            myPieces.push_back(entry);
+            myGroups = std::max(myGroups, group+1);
+        }
+
+        template<class S>
+        void parse ( const basic_pattern<C,S>& pattern )
+        {
+            const_char_ptr data = myText.empty()? 0 : &myText[0];
+            const int size = int(myText.size());
+            int i = 0;
+            while (i < size)
+            {
+                const int start = i;
+                while ((i < size) && (data[i] != char_type('$'))) {
+                    ++i;
+                }
+                literal(start, i-start);
+                if (i == size) {
+                    break;
+                }
+                // Skip '$'.
+                if (++i == size) {
+                    throw (exception(0, "replacement: trailing '$'"));
+                }
+                int group = -1;
+                if (data[i] == char_type('$')) {
+                    literal(i++, 1); continue;
+                }
+                if (is_digit(data[i])) {
+                    group = parse_index(data, size, i);
+                }
+                else if (data[i] == char_type('{'))
+                {
+                    const int name = ++i;
+                    while ((i < size) && (data[i] != char_type('}'))) {
+                        ++i;
+                    }
+                    if ((i == size) || (i == name)) {
+                        throw (exception(0, "replacement: bad '${...}'"));
+                    }
+                    int end = name;
+                    group = parse_index(data, i, end);
+                    if (end != i)
+                    {
+                        // Not a number, look up the group by name.
+                        std::vector<char_type> key(data+name, data+i);
+                        key.push_back(char_type());
+                        group = pattern.group_index(&key[0]);
+                        if (group < 0) {
+                            throw (exception(PCRE_ERROR_NOSUBSTRING,
+                                             "replacement: unknown name"));
+                        }
+                    }
+                    ++i;
+                }
+                else {
+                    throw (exception(0, "replacement: invalid '$'"));
+                }
+                if (group > pattern.capturing_groups()) {
+                    throw (exception(PCRE_ERROR_NOSUBSTRING,
+                                     "replacement: unknown group"));
+                }
+                reference(group);
+            }
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Number of groups the replacement needs (highest group
+         *  referenced, plus one), 0 for literal replacements.
+         */
+        int groups () const
+        {
+            return (myGroups);
+        }
+
+        /*!
+         * @brief Number of characters the replacement for @a match expands
+         *  to.
+         */
+        std::size_t size ( const match_type& match ) const
+        {
+            std::size_t total = 0;
+            for (std::size_t i=0; (i < myPieces.size()); ++i)
+            {
+                const piece& entry = myPieces[i];
+                total += (entry.group < 0)? entry.size
+                    : std::max(0, match.group_size(entry.group));
+            }
+            return (total);
+        }
+
+        /*!
+         * @brief Write the replacement for @a match to @a out.
+         * @tparam Out Output iterator accepting @c char_type values.
+         */
+        template<class Out>
+        Out expand ( const match_type& match, Out out ) const
+        {
+            for (std::size_t i=0; (i < myPieces.size()); ++i)
+            {
+                const_char_ptr data = 0;
+                int size = 0;
+                if (select(myPieces[i], match, data, size)) {
+                    out = std::copy(data, data+size, out);
+                }
+            }
+            return (out);
+        }
+
+        /*!
+         * @brief Append the replacement for @a match to @a output.
+         * @tparam S String type, with an @c append(data,size) member.
+         */
+        template<class S>
+        void append ( const match_type& match, S& output ) const
+        {
+            for (std::size_t i=0; (i < myPieces.size()); ++i)
+            {
+                const_char_ptr data = 0;
+                int size = 0;
+                if (select(myPieces[i], match, data, size)) {
+                    output.append(data, size);
+                }
+            }
+        }
+
+    private:
+        bool select ( const piece& entry, const match_type& match,
+                      const_char_ptr& data, int& size ) const
+        {
+            if (entry.group < 0) {
+                data = &myText[entry.base], size = entry.size;
+            }
+            else
+            {
+                const int base = match.group_base(entry.group);
+                if (base < 0) {
+                    return (false);
+                }
+                data = match.data()+base;
+                size = match.group_size(entry.group);
+            }
+            return (size > 0);
+        }
+    };
+
+    typedef basic_replacement<char> replacement;
+    typedef basic_replacement<wchar_t> wreplacement;
+
+    namespace detail {
+
+        // Copies the text between matches and the replacements to some
+        // output, stops after @a limit matches (if positive).
+        template<class C, class S, class Sink>
+        int replace ( const basic_pattern<C,S>& pattern,
+                      const C * data, int size,
+                      const basic_replacement<C>& replacement,
+                      Sink& sink, int limit, runtime_options options )
+        {
+            typedef basic_match_iterator<C,S> iterator;
+            data = subject(data);
+            int count = 0;
+            int done = 0;
+            for (iterator match(pattern, data, size, options), end;
+                 (match != end); ++match)
+            {
+                sink.literal(data+done, match->group_base()-done);
+                sink.expand(replacement, *match);
+                done = match->group_base()+match->group_size();
+                if (++count == limit) {
+                    break;
+                }
+            }
+            sink.literal(data+done, size-done);
+            return (count);
+        }
+
+        template<class C, class Out>
+        struct iterator_sink
+        {
+            Out out;
+
+            explicit iterator_sink ( Out out )
+                : out(out)
+            {}
+
+            void literal ( const C * data, int size )
+            {
+                // Note: with \K, a match may start before the previous one
+                //       ended, leaving nothing in between.
+                if (size > 0) {
+                    out = std::copy(data, data+size, out);
+                }
+            }
+
+            void expand ( const basic_replacement<C>& replacement,
+                          const basic_match_view<C>& match )
+            {
+                out = replacement.expand(match, out);
+            }
+        };
+
+        template<class C, class S>
+        struct string_sink
+        {
+            S& output;
+
+            explicit string_sink ( S& output )
+                : output(output)
+            {}
+
+            void literal ( const C * data, int size )
+            {
+                if (size > 0) {
+                    output.append(data, size);
+                }
+            }
+
+            void expand ( const basic_replacement<C>& replacement,
+                          const basic_match_view<C>& match )
+            {
+                replacement.append(match, output);
+            }
+        };
+
+    }
+
+    /*!
+     * @brief Copy @a size characters at @a data to @a out, replacing the
+     *  first match of @a pattern.
+     * @tparam Out Output iterator accepting @c C values.
+     * @return The output iterator, past the last character written.
+     */
+    template<class C, class S, class Out>
+    Out replace_first ( const basic_pattern<C,S>& pattern,
+                        const C * data, int size,
+                        const basic_replacement<C>& replacement, Out out,
+                        runtime_options options=runtime_options() )
+    {
+        detail::iterator_sink<C,Out> sink(out);
+        detail::replace(pattern, data, size, replacement, sink, 1, options);
+        return (sink.out);
+    }
+
+    /*!
+     * @brief Copy @a size characters at @a data to @a out, replacing all
+     *  (non-overlapping) matches of @a pattern.
+     * @tparam Out Output iterator accepting @c C values.
+     * @return The output iterator, past the last character written.
+     */
+    template<class C, class S, class Out>
+    Out replace_all ( const basic_pattern<C,S>& pattern,
+                      const C * data, int size,
+                      const basic_replacement<C>& replacement, Out out,
+                      runtime_options options=runtime_options() )
+    {
+        detail::iterator_sink<C,Out> sink(out);
+        detail::replace(pattern, data, size, replacement, sink, 0, options);
+        return (sink.out);
+    }
+
+    // pattern.replace_first(data,size,replacement,output,options) -> count.
+    template<class C, class S>
+    int basic_pattern<C,S>::replace_first
+        (const C * data, int size, const basic_replacement<C>& replacement,
+         S& output, runtime_options options) const
+    {
+        detail::string_sink<C,S> sink(output);
+        return (detail::replace
+                (*this, data, size, replacement, sink, 1, options));
+    }
+
+    // pattern.replace_all(data,size,replacement,output,options) -> count.
+    template<class C, class S>
+    int basic_pattern<C,S>::replace_all
+        (const C * data, int size, const basic_replacement<C>& replacement,
+         S& output, runtime_options options) const
+    {
+        detail::string_sink<C,S> sink(output);
+        return (detail::replace
+                (*this, data, size, replacement, sink, 0, options));
+    }
+
+    // pattern.replace_first(text,replacement,options) -> string.
+    template<class C, class S>
+    S basic_pattern<C,S>::replace_first
+        (const S& text, const basic_replacement<C>& replacement,
+         runtime_options options) const
+    {
+        S output;
+        replace_first(text.c_str(), int(text.size()),
+                      replacement, output, options);
+        return (output);
+    }
+
+    // pattern.replace_all(text,replacement,options) -> string.
+    template<class C, class S>
+    S basic_pattern<C,S>::replace_all
+        (const S& text, const basic_replacement<C>& replacement,
+         runtime_options options) const
+    {
+        S output;
+        output.reserve(text.size());
+        replace_all(text.c_str(), int(text.size()),
+                    replacement, output, options);
+        return (output);
+    }
+
+}
+
+#endif /* _pcrexx_replace_hpp__ */
@@ -0,0 +1,268 @@
+#ifndef _pcrexx_search_hpp__
+#define _pcrexx_search_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file search.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "prefilter.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace pcrexx {
+
+    namespace detail {
+
+        // Move a position in a (possibly huge) buffer back to the start of
+        // its character.  Only the last character before it is looked at.
+        template<class C>
+        std::size_t char_start ( const C * data, std::size_t size,
+                                 std::size_t offset )
+        {
+            typedef traits<C> traits_type;
+            const std::size_t back = std::min<std::size_t>
+                (offset, traits_type::max_char_size());
+            const std::size_t first = offset-back;
+            const int length = int(std::min(size-first, back+1));
+            return (first + traits_type::char_start
+                    (data+first, length, int(back)));
+        }
+
+    }
+
+    /*!
+     * @brief Report the first match in each line of a buffer.
+     * @param callback Called for each matching line as
+     *  @code callback(match, base) @endcode where @c match is a
+     *  @c basic_match_view<C> over the line and @a base is the offset of
+     *  the line in @a data.
+     *
+     * Lines are separated by @c '\\n', which is not part of the line.  The
+     * buffer is not copied, so it can be a memory-mapped file (see
+     * "mapped_file.hpp") larger than PCRE's 2GB limit on subjects.
+     */
+    template<class C, class S, class Callback>
+    void search_lines ( const basic_pattern<C,S>& pattern,
+                        const C * data, std::size_t size, Callback callback,
+                        runtime_options options=runtime_options() )
+    {
+        typedef std::char_traits<C> char_traits;
+        std::vector<int> results((1+pattern.capturing_groups())*3, 0);
+        std::size_t base = 0;
+        while (base < size)
+        {
+            const C * line = data + base;
+            const C * stop = char_traits::find(line, size-base, C('\n'));
+            const std::size_t length = (stop == 0)? size-base : stop-line;
+            if (length > std::size_t(std::numeric_limits<int>::max())) {
+                throw (exception(PCRE_ERROR_BADLENGTH, "search_lines()"));
+            }
+            const basic_match_view<C> match
+                (pattern, line, int(length),
+                 &results[0], int(results.size()), options);
+            if (match) {
+                callback(match, base);
+            }
+            base += length + 1;
+        }
+    }
+
+    /*!
+     * @brief Report matches that start in part of a buffer.
+     * @param from Position at which to resume searching, updated to the end
+     *  of the last reported match.
+     * @param not_empty Whether an empty match at @a from was already
+     *  reported, updated along with @a from.
+     * @param stop Matches starting at or after this position are ignored.
+     * @param sink Called as @code sink(match, base) @endcode for each
+     *  match, where @a base is the position of @c match.data() in @a data.
+     *  Returns @c false to stop the search.
+     * @param results Output vector, large enough for all groups.
+     *
+     * This is the building block for searching a buffer in parallel: the
+     * text around the range is visible to the pattern, so results are the
+     * same as when searching the whole buffer sequentially, provided the
+     * search resumes from the same state.  Individual matches are limited
+     * to a bit less than 2GB.
+     *
+     * Text that cannot contain a match is skipped without running PCRE,
+     * see @c basic_prefilter.
+     */
+    template<class C, class S, class Sink>
+    void search_range ( const basic_pattern<C,S>& pattern,
+                        const C * data, std::size_t size,
+                        std::size_t& from, bool& not_empty, std::size_t stop,
+                        Sink& sink, runtime_options options,
+                        std::vector<int>& results )
+    {
+        typedef traits<C> traits_type;
+        const std::size_t window = std::numeric_limits<int>::max();
+        const std::size_t context = pattern.context_size();
+        const bool unicode = ((pattern.compiled_options() & PCRE_UTF8) != 0);
+        basic_prefilter<C> filter(pattern, options);
+        // Window known to hold valid UTF, so that searching any part of it
+        // again needs no check.
+        std::size_t checked_base = 0;
+        std::size_t checked_end = 0;
+        while (from < stop)
+        {
+            std::size_t base = from - std::min(from, context);
+            if (unicode) {
+                base = detail::char_start(data, size, base);
+            }
+            const bool capped = (size-base > window);
+            int length = capped? int(window) : int(size-base);
+            runtime_options current = options;
+            if (capped)
+            {
+                current.accept_partial_hard();
+                if (unicode) {
+                    length = traits_type::whole_chars(data+base, length);
+                }
+            }
+            if (base > 0) {
+                current.not_start_of_line();
+            }
+            // Skip text where no match can start.  Partial matches need
+            // not contain the required literal, so only use it at the end.
+            const int offset = int(from-base);
+            const int next =
+                (!capped && !filter.possible(data+base, offset, length))? -1 :
+                filter.next(data+base, offset, length);
+            if ((next < 0) && !capped) {
+                return;
+            }
+            if (next < 0) {
+                from = base+length, not_empty = false;
+                continue;
+            }
+            if (next != offset) {
+                from = base+next, not_empty = false;
+                continue;
+            }
+            if (not_empty) {
+                current.not_empty_at_start();
+            }
+            if ((base >= checked_base) && (base+length <= checked_end)) {
+                current.no_utf_check();
+            }
+            const int status = pattern.execute
+                (data+base, length, int(from-base), current,
+                 &results[0], int(results.size()));
+            if ((status >= 0) || (status == PCRE_ERROR_NOMATCH) ||
+                (status == PCRE_ERROR_PARTIAL)) {
+                checked_base = base, checked_end = base+length;
+            }
+            if (status == PCRE_ERROR_NOMATCH)
+            {
+                if (!capped) {
+                    return;
+                }
+                from = base+length, not_empty = false;
+                continue;
+            }
+            if (status == PCRE_ERROR_PARTIAL)
+            {
+                const std::size_t start = base+results[0];
+                if ((start == from) || (start >= stop))
+                {
+                    if (start < stop) {
+                        throw (exception(status, "search_range()"));
+                    }
+                    return;
+                }
+                from = start, not_empty = false;
+                continue;
+            }
+            if (status < 0) {
+                throw_exception(status, "search_range()");
+            }
+            if (base+results[0] >= stop) {
+                return;
+            }
+            from = base+results[1];
+            not_empty = (results[0] == results[1]);
+            const int groups = (status == 0)? int(results.size())/3 : status;
+            if (!sink(basic_match_view<C>
+                      (data+base, length, &results[0], groups), base)) {
+                return;
+            }
+        }
+    }
+
+    /*!
+     * @brief Report all non-overlapping matches in a buffer.
+     * @param callback Called for each match as
+     *  @code callback(match, base) @endcode where @c match is a
+     *  @c basic_match_view<C> and @a base is the offset of
+     *  @c match.data() in @a data.
+     *
+     * The buffer is not copied, so it can be a memory-mapped file (see
+     * "mapped_file.hpp").  Buffers larger than PCRE's 2GB limit on subjects
+     * are searched in overlapping windows, using partial matching to find
+     * matches that straddle them.  Individual matches are still limited to
+     * a bit less than 2GB.
+     *
+     * Text that cannot contain a match is skipped without running PCRE,
+     * see @c basic_prefilter.
+     *
+     * @see search_range()
+     */
+    template<class C, class S, class Callback>
+    void search_buffer ( const basic_pattern<C,S>& pattern,
+                         const C * data, std::size_t size, Callback callback,
+                         runtime_options options=runtime_options() )
+    {
+        data = detail::subject(data);
+        std::vector<int> results((1+pattern.capturing_groups())*3, 0);
+        std::size_t from = 0;
+        bool not_empty = false;
+        const auto sink = [&callback] ( const basic_match_view<C>& match,
+                                        std::size_t base )
+        {
+            callback(match, base); return (true);
+        };
+        // Note: the (empty) end of the buffer is searched too.
+        search_range(pattern, data, size, from, not_empty, size+1,
+                     sink, options, results);
+    }
+
+}
+
+#endif /* _pcrexx_search_hpp__ */
@@ -0,0 +1,277 @@
+#ifndef _pcrexx_split_hpp__
+#define _pcrexx_split_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file split.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "iterator.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "string_ref.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Forward iterator over the fields between matches of a pattern.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * Fields refer to the subject text, which must outlive the iterator.
+     * Matches are found lazily, one per field, using @c
+     * basic_match_iterator (so empty matches split too, between each
+     * character).  A subject with @a n matches has @a n+1 fields, some of
+     * which may be empty.
+     *
+     * When captures are requested, the groups captured by each match are
+     * produced after the field that precedes it, in order.  Groups that did
+     * not participate in the match produce an empty field with null data.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_split_iterator
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+        typedef basic_match_iterator<C,S> match_iterator;
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef basic_string_ref<char_type> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type * pointer;
+        typedef const value_type& reference;
+
+    private:
+        typedef typename traits<C>::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        const_char_ptr myData;
+        int mySize;
+        match_iterator myMatch;
+        int myLimit;
+        int mySplits;
+        int myGroups;
+
+        // Start of the next field, and current group of the match (0 for
+        // the field that precedes it).
+        int myNext;
+        int myGroup;
+        bool myLast;
+        bool myEnd;
+        value_type myField;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Build an end-of-sequence iterator.
+         */
+        basic_split_iterator ()
+            : myData(0), mySize(0), myMatch(), myLimit(0), mySplits(0),
+              myGroups(0), myNext(0), myGroup(0), myLast(true), myEnd(true),
+              myField()
+        {}
+
+        /*!
+         * @brief Split @a data on matches of @a pattern.
+         * @param limit Maximum number of splits, 0 for no limit.  The last
+         *  field holds the rest of the subject.
+         * @param captures Produce the groups captured by each match.
+         */
+        basic_split_iterator ( const pattern_type& pattern,
+                               const_char_ptr data, int size,
+                               int limit=0, bool captures=false,
+                               runtime_options options=runtime_options() )
+            : myData(detail::subject(data)), mySize(size),
+              myMatch(pattern, myData, size, options),
+              myLimit(limit), mySplits(0),
+              myGroups(captures? pattern.capturing_groups() : 0),
+              myNext(0), myGroup(0), myLast(false), myEnd(false), myField()
+        {
+            next_field();
+        }
+
+        /* methods. */
+    private:
+        void next_field ()
+        {
+            const match_iterator end;
+            myGroup = 0;
+            if ((myMatch != end) && ((myLimit == 0) || (mySplits < myLimit)))
+            {
+                // Note: with \K, a match may start before the previous one
+                //       ended, leaving an empty field.
+                const int base = myMatch->group_base();
+                myField = value_type(myData+myNext,
+                                     std::max(base-myNext, 0));
+                myNext = base+myMatch->group_size();
+                ++mySplits;
+                return;
+            }
+            // Rest of the subject.
+            myField = value_type(myData+myNext, mySize-myNext);
+            myLast = true;
+        }
+
+        void advance ()
+        {
+            if (myLast) {
+                myEnd = true, myField = value_type(); return;
+            }
+            if (myGroup < myGroups) {
+                myField = myMatch->group(++myGroup); return;
+            }
+            // Past the limit, the next match would never be used.
+            if ((myLimit == 0) || (mySplits < myLimit)) {
+                ++myMatch;
+            }
+            next_field();
+        }
+
+        /* operators. */
+    public:
+        reference operator* () const
+        {
+            return (myField);
+        }
+
+        pointer operator-> () const
+        {
+            return (&myField);
+        }
+
+        basic_split_iterator& operator++ ()
+        {
+            advance(); return (*this);
+        }
+
+        basic_split_iterator operator++ ( int )
+        {
+            basic_split_iterator copy(*this); advance(); return (copy);
+        }
+
+        bool operator== ( const basic_split_iterator& other ) const
+        {
+            if (myEnd || other.myEnd) {
+                return (myEnd == other.myEnd);
+            }
+            return ((myData == other.myData) && (myNext == other.myNext) &&
+                    (myGroup == other.myGroup) && (myLast == other.myLast));
+        }
+
+        bool operator!= ( const basic_split_iterator& other ) const
+        {
+            return (!(*this == other));
+        }
+    };
+
+    /*!
+     * @brief All fields of a subject split on a pattern, for use in loops.
+     *
+     * @code
+     *  pcrexx::split_range fields = pattern.split(data, size);
+     *  for (pcrexx::split_iterator i = fields.begin();
+     *       i != fields.end(); ++i)
+     *  {
+     *      // use i->data(), i->size(), ...
+     *  }
+     * @endcode
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_split_range
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+        typedef basic_split_iterator<C,S> iterator;
+        typedef basic_split_iterator<C,S> const_iterator;
+
+    private:
+        typedef typename traits<C>::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        const pattern_type& myPattern;
+        const_char_ptr myData;
+        int mySize;
+        int myLimit;
+        bool myCaptures;
+        runtime_options myOptions;
+
+        /* construction. */
+    public:
+        basic_split_range ( const pattern_type& pattern,
+                            const_char_ptr data, int size,
+                            int limit=0, bool captures=false,
+                            runtime_options options=runtime_options() )
+            : myPattern(pattern), myData(data), mySize(size),
+              myLimit(limit), myCaptures(captures), myOptions(options)
+        {}
+
+        /* methods. */
+    public:
+        iterator begin () const
+        {
+            return (iterator(myPattern, myData, mySize,
+                             myLimit, myCaptures, myOptions));
+        }
+
+        iterator end () const
+        {
+            return (iterator());
+        }
+    };
+
+    typedef basic_split_iterator<char> split_iterator;
+    typedef basic_split_iterator<wchar_t> wsplit_iterator;
+
+    typedef basic_split_range<char> split_range;
+    typedef basic_split_range<wchar_t> wsplit_range;
+
+    // pattern.split(data,size,limit,captures,options) -> split_range.
+    template<class C, class S>
+    basic_split_range<C,S> basic_pattern<C,S>::split
+        (const C * data, int size, int limit, bool captures,
+         runtime_options options) const
+    {
+        return (basic_split_range<C,S>
+                (*this, data, size, limit, captures, options));
+    }
+
+}
+
+#endif /* _pcrexx_split_hpp__ */
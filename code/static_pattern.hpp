@@ -0,0 +1,447 @@
+#ifndef _pcrexx_static_pattern_hpp__
+#define _pcrexx_static_pattern_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file static_pattern.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "string_ref.hpp"
+#include "syntax.hpp"
+#include "traits.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace pcrexx {
+
+    namespace detail {
+
+        // Scanners for regular expressions known at compile time, built on
+        // those in "syntax.hpp" (see there for the recursion).  The scan is
+        // only concerned with groups: it skips escapes, \Q...\E quotes,
+        // (?#...) comments and character classes (including POSIX classes),
+        // and tells capturing groups from other parentheses.  Branch
+        // resets, which renumber groups, are rejected.  So is extended
+        // mode, e.g. "(?x)": its "#" comments run to the end of the line
+        // and may contain anything, including parentheses.
+
+        // Whether the group at i (at "(") is a branch reset.
+        template<class C>
+        constexpr bool branch_reset ( const C * text, int i )
+        {
+            return ((text[i+1] == C('?')) && (text[i+2] == C('|')));
+        }
+
+        // Whether the group at i (after "(") is named.
+        template<class C>
+        constexpr bool named ( const C * text, int i )
+        {
+            return ((text[i] == C('?')) &&
+                    (((text[i+1] == C('<')) && (text[i+2] != C('=')) &&
+                      (text[i+2] != C('!'))) ||
+                     (text[i+1] == C('\'')) ||
+                     ((text[i+1] == C('P')) && (text[i+2] == C('<')))));
+        }
+
+        // Whether the group at i (after "(") captures.
+        template<class C>
+        constexpr bool capturing ( const C * text, int i )
+        {
+            return (((text[i] != C('?')) && (text[i] != C('*'))) ||
+                    named(text, i));
+        }
+
+        // Index of the name of the named group at i (after "(").
+        template<class C>
+        constexpr int name_start ( const C * text, int i )
+        {
+            return ((text[i+1] == C('P'))? i+3 : i+2);
+        }
+
+        template<class C>
+        constexpr bool same_name ( const C * text, int i,
+                                   const C * name, int j )
+        {
+            return ((name[j] == C(0))?
+                    ((text[i] == C('>')) || (text[i] == C('\''))) :
+                    (text[i] == name[j]) && same_name(text, i+1, name, j+1));
+        }
+
+        // Number of capturing groups from i, -1 on syntax errors.
+        template<class C>
+        constexpr int count ( const C * text, int i, int depth, int groups );
+
+        template<class C>
+        constexpr int count_from ( const C * text, int i,
+                                   int depth, int groups )
+        {
+            return ((i < 0)? -1 : count(text, i, depth, groups));
+        }
+
+        template<class C>
+        constexpr int count ( const C * text, int i, int depth, int groups )
+        {
+            return ((text[i] == C(0))? ((depth == 0)? groups : -1) :
+                    (text[i] == C('\\'))?
+                        ((text[i+1] == C(0))? -1 :
+                         (text[i+1] == C('Q'))?
+                             count(text, quote_end(text, i+2), depth, groups) :
+                         count(text, i+2, depth, groups)) :
+                    (text[i] == C('['))?
+                        count_from(text, class_end
+                                   (text, class_body(text, i+1), true),
+                                   depth, groups) :
+                    (text[i] == C('('))?
+                        ((branch_reset(text, i) || extended(text, i))? -1 :
+                         comment(text, i)?
+                             count_from(text, comment_end(text, i+3),
+                                        depth, groups) :
+                         count(text, i+1, depth+1,
+                               groups+(capturing(text, i+1)? 1 : 0))) :
+                    (text[i] == C(')'))?
+                        ((depth == 0)? -1 :
+                         count(text, i+1, depth-1, groups)) :
+                    count(text, i+1, depth, groups));
+        }
+
+        // Index of the group named @a name from i, -1 if there is none.
+        template<class C>
+        constexpr int find ( const C * text, int i, int groups,
+                             const C * name );
+
+        template<class C>
+        constexpr int find_from ( const C * text, int i, int groups,
+                                  const C * name )
+        {
+            return ((i < 0)? -1 : find(text, i, groups, name));
+        }
+
+        template<class C>
+        constexpr int find ( const C * text, int i, int groups,
+                             const C * name )
+        {
+            return ((text[i] == C(0))? -1 :
+                    (text[i] == C('\\'))?
+                        ((text[i+1] == C(0))? -1 :
+                         (text[i+1] == C('Q'))?
+                             find(text, quote_end(text, i+2), groups, name) :
+                         find(text, i+2, groups, name)) :
+                    (text[i] == C('['))?
+                        find_from(text, class_end
+                                  (text, class_body(text, i+1), true),
+                                  groups, name) :
+                    (text[i] == C('('))?
+                        ((branch_reset(text, i) || extended(text, i))? -1 :
+                         comment(text, i)?
+                             find_from(text, comment_end(text, i+3),
+                                       groups, name) :
+                         (named(text, i+1) &&
+                          same_name(text, name_start(text, i+1), name, 0))?
+                             groups+1 :
+                         find(text, i+1, groups+(capturing(text, i+1)? 1 : 0),
+                              name)) :
+                    find(text, i+1, groups, name));
+        }
+
+    }
+
+    /*!
+     * @brief Check, at compile time, that parentheses and character
+     *  classes in @a text are balanced.
+     *
+     * This is no substitute for compiling the pattern, which checks the
+     * rest of the syntax.  Branch resets, i.e. "(?|...)", are rejected
+     * since they renumber groups.  Extended mode, i.e. "(?x)", is rejected
+     * since groups can't be told from comments without implementing all of
+     * it (use "(?#...)" comments instead).
+     */
+    template<class C>
+    constexpr bool static_syntax_ok ( const C * text )
+    {
+        return (detail::count(text, 0, 0, 0) >= 0);
+    }
+
+    /*!
+     * @brief Number of capturing groups in @a text, computed at compile
+     *  time.
+     *
+     * Unbalanced expressions don't compile when used as a constant (and
+     * throw otherwise).
+     */
+    template<class C>
+    constexpr int static_capture_count ( const C * text )
+    {
+        return (static_syntax_ok(text)? detail::count(text, 0, 0, 0) :
+                throw (exception(0, "static_capture_count(): syntax")));
+    }
+
+    /*!
+     * @brief Index of the group named @a name in @a text, computed at
+     *  compile time.
+     *
+     * Unknown names don't compile when used as a constant (and throw
+     * otherwise).
+     */
+    template<class C>
+    constexpr int static_group_index ( const C * text, const C * name )
+    {
+        return ((detail::find(text, 0, 0, name) >= 0)?
+                detail::find(text, 0, 0, name) :
+                throw (exception(PCRE_ERROR_NOSUBSTRING,
+                                 "static_group_index(): unknown name")));
+    }
+
+    /*!
+     * @brief Result of a match using a @c basic_static_pattern.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam N Number of capturing groups.
+     *
+     * The output vector is a member array, so matching allocates nothing
+     * and a match declared as a local variable lives entirely on the
+     * stack.  Groups refer to the subject text, which must outlive the
+     * match.
+     */
+    template<class C, int N>
+    class basic_static_match
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef basic_string_ref<char_type> string_ref_type;
+        typedef basic_match_view<char_type> view_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        /* class data. */
+    public:
+        static const int groups_count = N;
+
+        /* data. */
+    private:
+        const_char_ptr myData;
+        int mySize;
+        int myGroups;
+        int myResults[3*(N+1)];
+
+        /* construction. */
+    public:
+        basic_static_match ()
+            : myData(0), mySize(0), myGroups(0)
+        {}
+
+        template<class S>
+        basic_static_match ( const basic_pattern<C,S>& pattern,
+                             const_char_ptr data, int size,
+                             runtime_options options=runtime_options(),
+                             int base=0 )
+            : myData(data), mySize(size), myGroups(0)
+        {
+            const int status = pattern.execute
+                (data, size, base, options, myResults, 3*(N+1));
+            if (status < 0)
+            {
+                if (status != PCRE_ERROR_NOMATCH) {
+                    throw_exception(status, "static_match()");
+                }
+                return;
+            }
+            myGroups = (status == 0)? N+1 : status;
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Get the offset of a specific group within the subject.
+         */
+        int group_base ( int i=0 ) const
+        {
+            return ((i < myGroups)? myResults[2*i] : -1);
+        }
+
+        /*!
+         * @brief Get the size of a specific group.
+         */
+        int group_size ( int i=0 ) const
+        {
+            return ((i < myGroups)? myResults[2*i+1]-myResults[2*i] : 0);
+        }
+
+        /*!
+         * @brief Refer to a specific group within the match.
+         */
+        string_ref_type group ( int i=0 ) const
+        {
+            const int base = group_base(i);
+            if (base < 0) {
+                return (string_ref_type());
+            }
+            return (string_ref_type(myData+base, group_size(i)));
+        }
+
+        /*!
+         * @brief Refer to a specific group, checked at compile time.
+         *
+         * @code
+         *  match.group<static_group_index(text, "year")>()
+         * @endcode
+         */
+        template<int I>
+        string_ref_type group () const
+        {
+            static_assert((I >= 0) && (I <= N), "no such group");
+            return (group(I));
+        }
+
+        /*!
+         * @brief Refer to the match as a match view (for use with other
+         *  pcrexx facilities).  The view refers to this object.
+         */
+        view_type view () const
+        {
+            return (view_type(myData, mySize, myResults, myGroups));
+        }
+
+        /* operators. */
+    public:
+        operator bool () const
+        {
+            return (myGroups > 0);
+        }
+
+        bool operator! () const
+        {
+            return (myGroups == 0);
+        }
+    };
+
+    /*!
+     * @brief Pattern with a capture count known at compile time.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam N Number of capturing groups, see @c static_capture_count().
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * For hard-coded expressions, the capture count and group indices can
+     * be computed at compile time, so matches need no metadata queries and
+     * no allocations:
+     * @code
+     *  constexpr const char date[] = "(?<year>\\d{4})-(?<month>\\d\\d)";
+     *  const pcrexx::static_pattern<pcrexx::static_capture_count(date)>
+     *      pattern(date);
+     *  const auto match = pattern(data, size);
+     *  if (match) {
+     *      match.group<pcrexx::static_group_index(date, "year")>();
+     *  }
+     * @endcode
+     *
+     * The pattern is still compiled at run time, and the constructor checks
+     * that PCRE agrees with @a N and with the index of each named group
+     * (e.g. @c compile_options::no_capture() changes the count, and
+     * duplicate names are not supported).  Like "(?x)" in the expression,
+     * @c compile_options::ignore_whitespace() is rejected.
+     */
+    template<class C, int N, class S=typename traits<C>::string>
+    class basic_static_pattern
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef basic_pattern<C,S> pattern_type;
+        typedef basic_static_match<C,N> match_type;
+
+        typedef S string_type;
+
+        /* data. */
+    private:
+        pattern_type myPattern;
+
+        /* construction. */
+    public:
+        explicit basic_static_pattern
+            ( const string_type& text,
+              compile_options options=compile_options(),
+              study_options study=study_options() )
+            : myPattern(text, options, study)
+        {
+            // Groups were counted without extended mode.
+            if ((myPattern.compiled_options() & PCRE_EXTENDED) != 0) {
+                throw (exception(0, "static_pattern(): extended mode"));
+            }
+            if (myPattern.capturing_groups() != N) {
+                throw (exception(0, "static_pattern(): group count"));
+            }
+            // Check indices computed by static_group_index() too.
+            const std::vector<string_type>& names = myPattern.group_names();
+            for (std::size_t i=0; (i < names.size()); ++i)
+            {
+                const char_type *const name = names[i].c_str();
+                if (detail::find(text.c_str(), 0, 0, name) !=
+                    myPattern.group_index(name)) {
+                    throw (exception(0, "static_pattern(): group index"));
+                }
+            }
+        }
+
+        /* methods. */
+    public:
+        const pattern_type& pattern () const
+        {
+            return (myPattern);
+        }
+
+        /* operators. */
+    public:
+        /*!
+         * @brief Match @a size characters at @a data.
+         * @param base Offset at which to start searching.
+         */
+        match_type operator() ( const char_type * data, int size,
+                                runtime_options options=runtime_options(),
+                                int base=0 ) const
+        {
+            return (match_type(myPattern, data, size, options, base));
+        }
+    };
+
+    template<int N>
+    using static_pattern = basic_static_pattern<char,N>;
+
+    template<int N>
+    using wstatic_pattern = basic_static_pattern<wchar_t,N>;
+
+}
+
+#endif /* _pcrexx_static_pattern_hpp__ */
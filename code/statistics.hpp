@@ -0,0 +1,235 @@
+#ifndef _pcrexx_statistics_hpp__
+#define _pcrexx_statistics_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file statistics.hpp
+ * @see http://www.pcre.org/pcre.txt
+ *
+ * Pattern objects keep these statistics only when @c PCREXX_STATISTICS is
+ * defined, otherwise they cost nothing.  Since this changes the layout of
+ * @c basic_pattern, define it the same way in all translation units.
+ */
+
+#include <pcre.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Copy of a pattern's statistics at some point in time.
+     */
+    struct statistics_snapshot
+    {
+        /* class data. */
+    public:
+        // Error codes are counted up to this value, the last slot counts
+        // all others.
+        static const int error_codes = 40;
+
+        // Bucket i counts executions that took less than 2^i nanoseconds
+        // (and at least 2^(i-1)), the last bucket counts all others.
+        static const int latency_buckets = 32;
+
+        /* data. */
+    public:
+        unsigned long long executions;
+        unsigned long long matches;
+        unsigned long long no_matches;
+        unsigned long long partial_matches;
+        unsigned long long errors;
+        // Text consumed by matches, see basic_pattern::statistics().
+        unsigned long long bytes_scanned;
+        unsigned long long nanoseconds;
+        unsigned long long errors_by_code[error_codes];
+        unsigned long long latency[latency_buckets];
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Number of errors with the (negative) PCRE error @a code.
+         */
+        unsigned long long errors_with_code ( int code ) const
+        {
+            return (errors_by_code[(-code < error_codes)?
+                                   -code : error_codes-1]);
+        }
+    };
+
+    /*!
+     * @brief Counters updated by each execution of a pattern.
+     *
+     * Counters are updated independently, using relaxed atomic operations,
+     * so a snapshot taken while matches are running may be slightly
+     * inconsistent (e.g. @c executions may not yet include a match that is
+     * already counted in @c matches).
+     */
+    class pattern_statistics
+    {
+        // Not copyable.
+        pattern_statistics ( const pattern_statistics& );
+        pattern_statistics& operator= ( const pattern_statistics& );
+
+        /* nested types. */
+    public:
+        typedef std::chrono::steady_clock clock_type;
+        typedef std::atomic<unsigned long long> counter_type;
+
+        /* data. */
+    private:
+        counter_type myExecutions;
+        counter_type myMatches;
+        counter_type myNoMatches;
+        counter_type myPartialMatches;
+        counter_type myErrors;
+        counter_type myBytesScanned;
+        counter_type myNanoseconds;
+        counter_type myErrorsByCode[statistics_snapshot::error_codes];
+        counter_type myLatency[statistics_snapshot::latency_buckets];
+
+        /* construction. */
+    public:
+        pattern_statistics ()
+        {
+            reset();
+        }
+
+        /* class methods. */
+    private:
+        static int latency_bucket ( unsigned long long nanoseconds )
+        {
+            int bucket = 0;
+            while ((nanoseconds != 0) &&
+                   (bucket < statistics_snapshot::latency_buckets-1)) {
+                nanoseconds >>= 1, ++bucket;
+            }
+            return (bucket);
+        }
+
+        static void add ( counter_type& counter, unsigned long long value )
+        {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        static unsigned long long get ( const counter_type& counter )
+        {
+            return (counter.load(std::memory_order_relaxed));
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Count one execution, that started at @a start, scanned @a
+         *  bytes bytes and returned @a status.
+         */
+        void record ( clock_type::time_point start,
+                      std::size_t bytes, int status )
+        {
+            const unsigned long long nanoseconds =
+                std::chrono::duration_cast<std::chrono::nanoseconds>
+                (clock_type::now()-start).count();
+            add(myExecutions, 1);
+            add(myBytesScanned, bytes);
+            add(myNanoseconds, nanoseconds);
+            add(myLatency[latency_bucket(nanoseconds)], 1);
+            if (status >= 0) {
+                add(myMatches, 1);
+            }
+            else if (status == PCRE_ERROR_NOMATCH) {
+                add(myNoMatches, 1);
+            }
+            else if (status == PCRE_ERROR_PARTIAL) {
+                add(myPartialMatches, 1);
+            }
+            else
+            {
+                const int code = (-status < statistics_snapshot::error_codes)?
+                    -status : statistics_snapshot::error_codes-1;
+                add(myErrors, 1);
+                add(myErrorsByCode[code], 1);
+            }
+        }
+
+        statistics_snapshot snapshot () const
+        {
+            statistics_snapshot snapshot;
+            snapshot.executions = get(myExecutions);
+            snapshot.matches = get(myMatches);
+            snapshot.no_matches = get(myNoMatches);
+            snapshot.partial_matches = get(myPartialMatches);
+            snapshot.errors = get(myErrors);
+            snapshot.bytes_scanned = get(myBytesScanned);
+            snapshot.nanoseconds = get(myNanoseconds);
+            for (int i=0; (i < statistics_snapshot::error_codes); ++i) {
+                snapshot.errors_by_code[i] = get(myErrorsByCode[i]);
+            }
+            for (int i=0; (i < statistics_snapshot::latency_buckets); ++i) {
+                snapshot.latency[i] = get(myLatency[i]);
+            }
+            return (snapshot);
+        }
+
+        /*!
+         * @brief Copy the counters of @a other.
+         */
+        void assign ( const pattern_statistics& other )
+        {
+            myExecutions = get(other.myExecutions);
+            myMatches = get(other.myMatches);
+            myNoMatches = get(other.myNoMatches);
+            myPartialMatches = get(other.myPartialMatches);
+            myErrors = get(other.myErrors);
+            myBytesScanned = get(other.myBytesScanned);
+            myNanoseconds = get(other.myNanoseconds);
+            for (int i=0; (i < statistics_snapshot::error_codes); ++i) {
+                myErrorsByCode[i] = get(other.myErrorsByCode[i]);
+            }
+            for (int i=0; (i < statistics_snapshot::latency_buckets); ++i) {
+                myLatency[i] = get(other.myLatency[i]);
+            }
+        }
+
+        void reset ()
+        {
+            myExecutions = 0, myMatches = 0, myNoMatches = 0;
+            myPartialMatches = 0, myErrors = 0;
+            myBytesScanned = 0, myNanoseconds = 0;
+            for (int i=0; (i < statistics_snapshot::error_codes); ++i) {
+                myErrorsByCode[i] = 0;
+            }
+            for (int i=0; (i < statistics_snapshot::latency_buckets); ++i) {
+                myLatency[i] = 0;
+            }
+        }
+    };
+
+}
+
+#endif /* _pcrexx_statistics_hpp__ */
@@ -0,0 +1,235 @@
+#ifndef _pcrexx_stream_hpp__
+#define _pcrexx_stream_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file stream.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+#include <pcre.h>
+#include "exception.hpp"
+#include "match_view.hpp"
+#include "options.hpp"
+#include "pattern.hpp"
+#include "traits.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Search for matches in text that arrives in chunks.
+     * @tparam C Character type.  @c traits<C> must be defined.
+     * @tparam S String type, see @c basic_pattern.
+     *
+     * Chunks are searched as they are fed, using hard partial matching.
+     * When a match might continue past the end of a chunk, only the text
+     * from the start of that possible match is kept (along with enough
+     * text before it for lookbehind assertions), and the search resumes
+     * there when the next chunk arrives.  When nothing matches, only the
+     * lookbehind context is kept.
+     *
+     * Text kept between chunks starts one character before anything a
+     * search may look at, so once the start of the stream is dropped,
+     * "\A" (which only matches at the start of the buffer) can't match
+     * mid-stream.
+     *
+     * Matches are reported to a callback as they are found, as:
+     * @code
+     *  void callback ( const basic_match_view<C>& match, long long base );
+     * @endcode
+     * where @a base is the position of @c match.data() in the stream.  The
+     * view refers to an internal buffer and is only valid in the callback.
+     *
+     * @note For JIT-compiled patterns, study them with
+     *  @c study_options::jit_partial_hard() as well, or partial matching
+     *  uses the (slower) interpreter.
+     */
+    template<class C, class S=typename traits<C>::string>
+    class basic_stream_matcher
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef traits<char_type> traits_type;
+
+        typedef basic_pattern<C,S> pattern_type;
+        typedef basic_match_view<C> match_type;
+
+        typedef long long offset_type;
+
+    private:
+        typedef typename traits_type::const_char_ptr const_char_ptr;
+
+        /* data. */
+    private:
+        const pattern_type& myPattern;
+        runtime_options myOptions;
+
+        // Code units kept before the search position, see above.
+        int myContext;
+        std::vector<char_type> myBuffer;
+        std::vector<int> myResults;
+        offset_type myOffset;
+        int myBase;
+        bool myNotEmpty;
+
+        /* construction. */
+    public:
+        basic_stream_matcher ( const pattern_type& pattern,
+                               runtime_options options=runtime_options() )
+            : myPattern(pattern), myOptions(options),
+              myContext(pattern.context_size()+1), myBuffer(),
+              myResults((1+pattern.capturing_groups())*3, 0),
+              myOffset(0), myBase(0), myNotEmpty(false)
+        {}
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Position in the stream of the first retained character.
+         */
+        offset_type offset () const
+        {
+            return (myOffset);
+        }
+
+        /*!
+         * @brief Number of characters retained between chunks.
+         */
+        int retained () const
+        {
+            return (int(myBuffer.size()));
+        }
+
+        /*!
+         * @brief Search the next chunk of the stream.
+         */
+        template<class Callback>
+        void feed ( const_char_ptr data, int size, Callback callback )
+        {
+            myBuffer.insert(myBuffer.end(), data, data+size);
+            if (myBuffer.empty()) {
+                return;
+            }
+            // Don't split characters between chunks.
+            const int total = int(myBuffer.size());
+            const bool unicode =
+                ((myPattern.compiled_options() & PCRE_UTF8) != 0);
+            const int whole = unicode
+                ? traits_type::whole_chars(&myBuffer[0], total) : total;
+            runtime_options options = myOptions;
+            options.accept_partial_hard();
+            int keep = std::min(search(whole, options, callback), whole);
+            // Don't keep a partial character either.
+            if (unicode) {
+                keep = traits_type::char_start(&myBuffer[0], total, keep);
+            }
+            discard(keep);
+        }
+
+        /*!
+         * @brief Search what is left at the end of the stream.
+         *
+         * The matcher can be reused for a new stream afterwards.
+         */
+        template<class Callback>
+        void finish ( Callback callback )
+        {
+            if (!myBuffer.empty()) {
+                search(int(myBuffer.size()), myOptions, callback);
+            }
+            myBuffer.clear();
+            myOffset = 0, myBase = 0, myNotEmpty = false;
+        }
+
+    private:
+        // Returns the offset of the first character to keep.
+        template<class Callback>
+        int search ( int size, runtime_options options, Callback& callback )
+        {
+            if (myOffset > 0) {
+                options.not_start_of_line();
+            }
+            while (myBase <= size)
+            {
+                runtime_options current = options;
+                if (myNotEmpty) {
+                    current.not_empty_at_start();
+                }
+                const int status = myPattern.execute
+                    (&myBuffer[0], size, myBase, current,
+                     &myResults[0], int(myResults.size()));
+                // Note: an empty match may already have been reported
+                //       where the search resumes.
+                if (status == PCRE_ERROR_NOMATCH) {
+                    myNotEmpty = myNotEmpty && (myBase == size);
+                    myBase = size;
+                    return (std::max(0, size-myContext));
+                }
+                if (status == PCRE_ERROR_PARTIAL) {
+                    myNotEmpty = myNotEmpty && (myBase == myResults[0]);
+                    myBase = myResults[0];
+                    return (std::max(0, myBase-myContext));
+                }
+                if (status < 0) {
+                    throw_exception(status, "stream_matcher()");
+                }
+                const int groups =
+                    (status == 0)? int(myResults.size())/3 : status;
+                callback(match_type(&myBuffer[0], size,
+                                    &myResults[0], groups), myOffset);
+                myNotEmpty = (myResults[0] == myResults[1]);
+                myBase = myResults[1];
+                // The buffer is valid, no need to check it again.
+                options.no_utf_check();
+            }
+            return (std::max(0, size-myContext));
+        }
+
+        void discard ( int count )
+        {
+            myBuffer.erase(myBuffer.begin(), myBuffer.begin()+count);
+            myOffset += count, myBase -= count;
+        }
+    };
+
+    /*!
+     * @brief Stream matcher for UTF-8 text.
+     */
+    typedef basic_stream_matcher<char> stream_matcher;
+
+    /*!
+     * @brief Stream matcher for wide text.
+     */
+    typedef basic_stream_matcher<wchar_t> wstream_matcher;
+
+}
+
+#endif /* _pcrexx_stream_hpp__ */
@@ -0,0 +1,168 @@
+#ifndef _pcrexx_string_ref_hpp__
+#define _pcrexx_string_ref_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file string_ref.hpp
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Non-owning reference to a range of characters.
+     * @tparam C Character type.
+     *
+     * References are used to access captured groups without copying them
+     * out of the subject text.  The referenced text must outlive them.
+     */
+    template<class C>
+    class basic_string_ref
+    {
+        /* nested types. */
+    public:
+        typedef C char_type;
+        typedef std::char_traits<char_type> char_traits;
+
+        typedef const char_type * const_iterator;
+        typedef const char_type * iterator;
+
+        /* data. */
+    private:
+        const char_type * myData;
+        std::size_t mySize;
+
+        /* construction. */
+    public:
+        basic_string_ref ()
+            : myData(0), mySize(0)
+        {}
+
+        basic_string_ref ( const char_type * data, std::size_t size )
+            : myData(data), mySize(size)
+        {}
+
+        basic_string_ref ( const char_type * data )
+            : myData(data), mySize(char_traits::length(data))
+        {}
+
+        /* methods. */
+    public:
+        const char_type * data () const
+        {
+            return (myData);
+        }
+
+        std::size_t size () const
+        {
+            return (mySize);
+        }
+
+        bool empty () const
+        {
+            return (mySize == 0);
+        }
+
+        const_iterator begin () const
+        {
+            return (myData);
+        }
+
+        const_iterator end () const
+        {
+            return (myData + mySize);
+        }
+
+        /*!
+         * @brief Lexicographic comparison, like @c std::basic_string.
+         */
+        int compare ( const basic_string_ref& other ) const
+        {
+            const int result = char_traits::compare
+                (myData, other.myData, std::min(mySize, other.mySize));
+            if (result != 0) {
+                return (result);
+            }
+            return ((mySize < other.mySize)? -1 :
+                    (mySize > other.mySize)? 1 : 0);
+        }
+
+        /*!
+         * @brief Copy the referenced text into a string.
+         * @tparam S String type, must have a constructor that accepts a
+         *  pointer and a size.
+         */
+        template<class S>
+        S str () const
+        {
+            return (S(myData, mySize));
+        }
+
+        std::basic_string<char_type> str () const
+        {
+            return (std::basic_string<char_type>(myData, mySize));
+        }
+
+        /* operators. */
+    public:
+        char_type operator[] ( std::size_t i ) const
+        {
+            return (myData[i]);
+        }
+    };
+
+    template<class C>
+    bool operator== ( const basic_string_ref<C>& lhs,
+                      const basic_string_ref<C>& rhs )
+    {
+        return (lhs.compare(rhs) == 0);
+    }
+
+    template<class C>
+    bool operator!= ( const basic_string_ref<C>& lhs,
+                      const basic_string_ref<C>& rhs )
+    {
+        return (lhs.compare(rhs) != 0);
+    }
+
+    template<class C>
+    bool operator< ( const basic_string_ref<C>& lhs,
+                     const basic_string_ref<C>& rhs )
+    {
+        return (lhs.compare(rhs) < 0);
+    }
+
+    typedef basic_string_ref<char> string_ref;
+    typedef basic_string_ref<wchar_t> wstring_ref;
+
+}
+
+#endif /* _pcrexx_string_ref_hpp__ */
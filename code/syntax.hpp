@@ -0,0 +1,147 @@
+#ifndef _pcrexx_syntax_hpp__
+#define _pcrexx_syntax_hpp__
+
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file syntax.hpp
+ * @see http://www.pcre.org/pcre.txt
+ */
+
+namespace pcrexx {
+
+    namespace detail {
+
+        // Scanners for the parts of a regular expression that hide its
+        // structure (quotes, character classes and comments).  They are
+        // usable at compile time: C++11 constexpr functions are limited to
+        // a single expression, hence the recursion (one level per
+        // character, so very long expressions may need a larger
+        // -fconstexpr-depth).
+
+        // Index after "\E", or of the end of the text.
+        template<class C>
+        constexpr int quote_end ( const C * text, int i )
+        {
+            return ((text[i] == C(0))? i :
+                    ((text[i] == C('\\')) && (text[i+1] == C('E')))? i+2 :
+                    quote_end(text, i+1));
+        }
+
+        // Index after the ":]" (or ".]", "=]") that ends a POSIX class
+        // name, -1 if none (like PCRE, give up at the first "]").
+        template<class C>
+        constexpr int posix_end ( const C * text, int i, C delimiter )
+        {
+            return ((text[i] == C(0))? -1 :
+                    ((text[i] == delimiter) && (text[i+1] == C(']')))? i+2 :
+                    (text[i] == C(']'))? -1 :
+                    posix_end(text, i+1, delimiter));
+        }
+
+        // Whether a POSIX class name, e.g. "[:alpha:]", starts at i.
+        template<class C>
+        constexpr bool posix ( const C * text, int i )
+        {
+            return ((text[i] == C('[')) &&
+                    ((text[i+1] == C(':')) || (text[i+1] == C('.')) ||
+                     (text[i+1] == C('='))));
+        }
+
+        // Index after the "]" that ends a character class, -1 if none.
+        template<class C>
+        constexpr int class_end ( const C * text, int i, bool first );
+
+        // Resumes at i, or at j (a literal "[") if i is -1.
+        template<class C>
+        constexpr int class_end_from ( const C * text, int i, int j )
+        {
+            return ((i < 0)? class_end(text, j, false) :
+                    class_end(text, i, false));
+        }
+
+        template<class C>
+        constexpr int class_end ( const C * text, int i, bool first )
+        {
+            return ((text[i] == C(0))? -1 :
+                    (text[i] == C('\\'))? ((text[i+1] == C(0))? -1 :
+                                           class_end(text, i+2, false)) :
+                    posix(text, i)?
+                        class_end_from(text, posix_end
+                                       (text, i+2, text[i+1]), i+1) :
+                    ((text[i] == C(']')) && !first)? i+1 :
+                    class_end(text, i+1, false));
+        }
+
+        // Index after the ")" that ends a comment, -1 if none.
+        template<class C>
+        constexpr int comment_end ( const C * text, int i )
+        {
+            return ((text[i] == C(0))? -1 :
+                    (text[i] == C(')'))? i+1 :
+                    comment_end(text, i+1));
+        }
+
+        // Whether the group at i (at "(") is a comment.
+        template<class C>
+        constexpr bool comment ( const C * text, int i )
+        {
+            return ((text[i+1] == C('?')) && (text[i+2] == C('#')));
+        }
+
+        // Whether the option letters from i turn on extended mode.
+        template<class C>
+        constexpr bool extended_from ( const C * text, int i )
+        {
+            return ((text[i] == C('x')) ||
+                    ((((text[i] >= C('a')) && (text[i] <= C('z'))) ||
+                      ((text[i] >= C('A')) && (text[i] <= C('Z')))) &&
+                     extended_from(text, i+1)));
+        }
+
+        // Whether the group at i (at "(") turns on extended mode, where
+        // white space and "#" comments are ignored, e.g. "(?x)" or
+        // "(?ix:" (but not "(?-x)").
+        template<class C>
+        constexpr bool extended ( const C * text, int i )
+        {
+            return ((text[i+1] == C('?')) && extended_from(text, i+2));
+        }
+
+        // Index of the first character of a class, after "[".
+        template<class C>
+        constexpr int class_body ( const C * text, int i )
+        {
+            return ((text[i] == C('^'))? i+1 : i);
+        }
+
+    }
+
+}
+
+#endif /* _pcrexx_syntax_hpp__ */
@@ -0,0 +1,212 @@
+#ifndef _pcrexx_thread_pool_hpp__
+#define _pcrexx_thread_pool_hpp__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file thread_pool.hpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pcrexx {
+
+    /*!
+     * @brief Fixed set of worker threads for parallel searches.
+     *
+     * Work is submitted as a number of independent items through @c run(),
+     * which blocks until all items are processed.  Workers (and the caller)
+     * claim items one at a time from a shared counter, so threads that get
+     * cheap items simply claim more of them.
+     *
+     * @note Pools are thread-safe, and @c run() may be called from inside
+     *  an item.
+     */
+    class thread_pool
+    {
+        // Not copyable.
+        thread_pool ( const thread_pool& );
+        thread_pool& operator= ( const thread_pool& );
+
+        /* data. */
+    private:
+        std::vector<std::thread> myThreads;
+        std::deque< std::function<void()> > myTasks;
+        std::mutex myLock;
+        std::condition_variable myReady;
+        bool myStop;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Start @a size worker threads (one per core by default).
+         */
+        explicit thread_pool ( std::size_t size=0 )
+            : myStop(false)
+        {
+            if (size == 0) {
+                size = std::max(1u, std::thread::hardware_concurrency());
+            }
+            myThreads.reserve(size);
+            try {
+                for (std::size_t i=0; (i < size); ++i) {
+                    myThreads.push_back(std::thread(&thread_pool::work, this));
+                }
+            }
+            catch (...) {
+                stop(); throw;
+            }
+        }
+
+        ~thread_pool ()
+        {
+            stop();
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Number of worker threads.
+         */
+        std::size_t size () const
+        {
+            return (myThreads.size());
+        }
+
+        /*!
+         * @brief Call @c item(i) for each @c i in <tt>[0,count)</tt>.
+         *
+         * If items throw, the first exception is rethrown here once all
+         * items are done.
+         */
+        template<class Item>
+        void run ( std::size_t count, Item item )
+        {
+            if (count == 0) {
+                return;
+            }
+            struct batch
+            {
+                std::atomic<std::size_t> next;
+                std::mutex lock;
+                std::condition_variable done;
+                std::size_t remaining;
+                std::exception_ptr error;
+            };
+            const std::shared_ptr<batch> state = std::make_shared<batch>();
+            state->next = 0;
+            state->remaining = count;
+            // Note: helpers that start late find nothing left to claim, and
+            //       never touch 'item' after the last one completes.
+            const std::function<void()> drain = [state, count, &item] ()
+            {
+                for (std::size_t i = state->next++;
+                     (i < count); i = state->next++)
+                {
+                    std::exception_ptr error;
+                    try {
+                        item(i);
+                    }
+                    catch (...) {
+                        error = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> guard(state->lock);
+                    if (error && !state->error) {
+                        state->error = error;
+                    }
+                    if (--state->remaining == 0) {
+                        state->done.notify_all();
+                    }
+                }
+            };
+            // Enlist as many workers as useful, then help out.  Since the
+            // caller claims items too, this completes even when all workers
+            // are busy (e.g. when called from inside an item).
+            {
+                std::lock_guard<std::mutex> guard(myLock);
+                for (std::size_t i=1; (i < count) && (i <= size()); ++i) {
+                    myTasks.push_back(drain);
+                }
+            }
+            myReady.notify_all();
+            drain();
+            std::unique_lock<std::mutex> guard(state->lock);
+            while (state->remaining > 0) {
+                state->done.wait(guard);
+            }
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+    private:
+        void work ()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> guard(myLock);
+                    while (!myStop && myTasks.empty()) {
+                        myReady.wait(guard);
+                    }
+                    if (myTasks.empty()) {
+                        return;
+                    }
+                    task.swap(myTasks.front());
+                    myTasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        void stop ()
+        {
+            {
+                std::lock_guard<std::mutex> guard(myLock);
+                myStop = true;
+            }
+            myReady.notify_all();
+            for (std::size_t i=0; (i < myThreads.size()); ++i) {
+                myThreads[i].join();
+            }
+        }
+    };
+
+}
+
+#endif /* _pcrexx_thread_pool_hpp__ */
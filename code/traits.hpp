@@ -28,6 +28,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <pcre.h>
+#include <cstddef>
 #include <string>
 
 namespace pcrexx {
@@ -38,6 +39,10 @@ namespace pcrexx {
     {
         typedef ::pcre* handle;
         typedef const ::pcre_extra* extra;
+        typedef ::pcre_extra* study_handle;
+        typedef ::pcre_extra study_data;
+        typedef ::pcre_jit_stack* jit_stack;
+        typedef ::pcre_jit_callback jit_callback;
 
         typedef char* char_ptr;
         typedef const char* const_char_ptr;
@@ -57,6 +62,43 @@ namespace pcrexx {
             ::pcre_free(pattern);
         }
 
+        static handle load ( const void * data )
+        {
+            return (static_cast<handle>(const_cast<void*>(data)));
+        }
+
+        static int unit_size ()
+        {
+            return (1);
+        }
+
+        static study_handle study ( handle pattern, int options,
+                                    const char ** help )
+        {
+            return (::pcre_study(pattern, options, help));
+        }
+
+        static void free_study ( study_handle extra )
+        {
+            ::pcre_free_study(extra);
+        }
+
+        static jit_stack allocate_jit_stack ( int start, int limit )
+        {
+            return (::pcre_jit_stack_alloc(start, limit));
+        }
+
+        static void free_jit_stack ( jit_stack stack )
+        {
+            ::pcre_jit_stack_free(stack);
+        }
+
+        static void assign_jit_stack ( study_handle extra,
+                                       jit_callback callback, void * data )
+        {
+            ::pcre_assign_jit_stack(extra, callback, data);
+        }
+
         static int query ( handle pattern, extra extra, int what, void * where )
         {
             return (::pcre_fullinfo(pattern, extra, what, where));
@@ -67,6 +109,18 @@ namespace pcrexx {
             return (::pcre_get_stringnumber(pattern, name));
         }
 
+        static int config ( int what, void * where )
+        {
+            return (::pcre_config(what, where));
+        }
+
+        static void set_allocator ( void * (*allocate)(std::size_t),
+                                    void (*release)(void*) )
+        {
+            ::pcre_malloc = allocate, ::pcre_free = release;
+            ::pcre_stack_malloc = allocate, ::pcre_stack_free = release;
+        }
+
         static int execute ( handle pattern, extra extra,
                              const_char_ptr data, int size, int base,
                              int options, int * results, int count )
@@ -75,21 +129,91 @@ namespace pcrexx {
                                 base, options, results, count));
         }
 
+        static int dfa_execute ( handle pattern, extra extra,
+                                 const_char_ptr data, int size, int base,
+                                 int options, int * results, int count,
+                                 int * workspace, int workspace_size )
+        {
+            return (::pcre_dfa_exec(pattern, extra, data, size,
+                                    base, options, results, count,
+                                    workspace, workspace_size));
+        }
+
+        static int next_char ( const_char_ptr data, int size, int offset )
+        {
+            // Skip UTF-8 continuation bytes.
+            ++offset;
+            while ((offset < size) && ((data[offset] & 0xc0) == 0x80)) {
+                ++offset;
+            }
+            return (offset);
+        }
+
+        static int char_start ( const_char_ptr data, int size, int offset )
+        {
+            // Move back over UTF-8 continuation bytes.
+            if (offset >= size) {
+                return (offset);
+            }
+            while ((offset > 0) && ((data[offset] & 0xc0) == 0x80)) {
+                --offset;
+            }
+            return (offset);
+        }
+
+        static int max_char_size ()
+        {
+            return (4);
+        }
+
+        static int whole_chars ( const_char_ptr data, int size )
+        {
+            // Find the lead byte of the last UTF-8 sequence and check
+            // that all of its continuation bytes are present.
+            for (int i=size-1; (i >= 0) && (i >= size-4); --i)
+            {
+                const unsigned char unit = data[i];
+                if ((unit & 0xc0) == 0x80) {
+                    continue;
+                }
+                const int length = ((unit & 0x80) == 0x00)? 1 :
+                                   ((unit & 0xe0) == 0xc0)? 2 :
+                                   ((unit & 0xf0) == 0xe0)? 3 : 4;
+                return ((size-i < length)? i : size);
+            }
+            return (size);
+        }
+
         static int table_offset ()
         {
             return (2);
         }
+
+        static int table_index ( const_char_ptr entry )
+        {
+            const unsigned char * data =
+                reinterpret_cast<const unsigned char*>(entry);
+            return ((data[0] << 8) | data[1]);
+        }
     };
 
-    template<> struct traits<wchar_t>
+    /*!
+     * @brief Traits for character types stored as UTF-16, using the 16-bit
+     *  PCRE library.
+     */
+    template<class C> struct pcre16_traits
     {
         typedef ::pcre16* handle;
         typedef const ::pcre16_extra* extra;
+        typedef ::pcre16_extra* study_handle;
+        typedef ::pcre16_extra study_data;
+        typedef ::pcre16_jit_stack* jit_stack;
+        typedef ::pcre16_jit_callback jit_callback;
 
-        typedef wchar_t * char_ptr;
-        typedef const wchar_t * const_char_ptr;
+        typedef C * char_ptr;
+        typedef const C * const_char_ptr;
 
-        typedef std::wstring string;
+        typedef std::basic_string<C> string;
 
         static handle compile ( const_char_ptr pattern, int options,
                                 int * error, const char ** help, int * offset,
@@ -104,6 +228,43 @@ namespace pcrexx {
             ::pcre16_free(pattern);
         }
 
+        static handle load ( const void * data )
+        {
+            return (static_cast<handle>(const_cast<void*>(data)));
+        }
+
+        static int unit_size ()
+        {
+            return (2);
+        }
+
+        static study_handle study ( handle pattern, int options,
+                                    const char ** help )
+        {
+            return (::pcre16_study(pattern, options, help));
+        }
+
+        static void free_study ( study_handle extra )
+        {
+            ::pcre16_free_study(extra);
+        }
+
+        static jit_stack allocate_jit_stack ( int start, int limit )
+        {
+            return (::pcre16_jit_stack_alloc(start, limit));
+        }
+
+        static void free_jit_stack ( jit_stack stack )
+        {
+            ::pcre16_jit_stack_free(stack);
+        }
+
+        static void assign_jit_stack ( study_handle extra,
+                                       jit_callback callback, void * data )
+        {
+            ::pcre16_assign_jit_stack(extra, callback, data);
+        }
+
         static int query ( handle pattern, extra extra, int what, void * where )
         {
             return (::pcre16_fullinfo(pattern, extra, what, where));
@@ -114,6 +275,18 @@ namespace pcrexx {
             return (::pcre16_get_stringnumber(pattern, to(name)));
         }
 
+        static int config ( int what, void * where )
+        {
+            return (::pcre16_config(what, where));
+        }
+
+        static void set_allocator ( void * (*allocate)(std::size_t),
+                                    void (*release)(void*) )
+        {
+            ::pcre16_malloc = allocate, ::pcre16_free = release;
+            ::pcre16_stack_malloc = allocate, ::pcre16_stack_free = release;
+        }
+
         static int execute ( handle pattern, extra extra,
                              const_char_ptr data, int size, int base,
                              int options, int * results, int count )
@@ -122,12 +295,61 @@ namespace pcrexx {
                                   base, options, results, count));
         }
 
+        static int dfa_execute ( handle pattern, extra extra,
+                                 const_char_ptr data, int size, int base,
+                                 int options, int * results, int count,
+                                 int * workspace, int workspace_size )
+        {
+            return (::pcre16_dfa_exec(pattern, extra, to(data), size,
+                                      base, options, results, count,
+                                      workspace, workspace_size));
+        }
+
+        static int next_char ( const_char_ptr data, int size, int offset )
+        {
+            // Skip the low surrogate after a high surrogate.
+            if (((data[offset] & 0xfc00) == 0xd800) && (offset+1 < size)) {
+                return (offset+2);
+            }
+            return (offset+1);
+        }
+
+        static int char_start ( const_char_ptr data, int size, int offset )
+        {
+            // Move back from a low surrogate to its high surrogate.
+            if ((offset > 0) && (offset < size) &&
+                ((data[offset] & 0xfc00) == 0xdc00) &&
+                ((data[offset-1] & 0xfc00) == 0xd800)) {
+                return (offset-1);
+            }
+            return (offset);
+        }
+
+        static int max_char_size ()
+        {
+            return (2);
+        }
+
+        static int whole_chars ( const_char_ptr data, int size )
+        {
+            // Hold back a trailing high surrogate.
+            if ((size > 0) && ((data[size-1] & 0xfc00) == 0xd800)) {
+                return (size-1);
+            }
+            return (size);
+        }
+
         static int table_offset ()
         {
             return (1);
         }
 
-    private:
+        static int table_index ( const_char_ptr entry )
+        {
+            return (*to(entry));
+        }
+
+    protected:
         static const_char_ptr from ( PCRE_SPTR16 pointer )
         {
             return (reinterpret_cast<const_char_ptr>(pointer));
@@ -139,6 +361,190 @@ namespace pcrexx {
         }
     };
 
+
+    /*!
+     * @brief Traits for character types stored as UTF-32, using the 32-bit
+     *  PCRE library.
+     */
+    template<class C> struct pcre32_traits
+    {
+        typedef ::pcre32* handle;
+        typedef const ::pcre32_extra* extra;
+        typedef ::pcre32_extra* study_handle;
+        typedef ::pcre32_extra study_data;
+        typedef ::pcre32_jit_stack* jit_stack;
+        typedef ::pcre32_jit_callback jit_callback;
+
+        typedef C * char_ptr;
+        typedef const C * const_char_ptr;
+
+        typedef std::basic_string<C> string;
+
+        static handle compile ( const_char_ptr pattern, int options,
+                                int * error, const char ** help, int * offset,
+                                const unsigned char * table )
+        {
+            return (::pcre32_compile2
+                    (to(pattern), options, error, help, offset, table));
+        }
+
+        static void release ( handle pattern )
+        {
+            ::pcre32_free(pattern);
+        }
+
+        static handle load ( const void * data )
+        {
+            return (static_cast<handle>(const_cast<void*>(data)));
+        }
+
+        static int unit_size ()
+        {
+            return (4);
+        }
+
+        static study_handle study ( handle pattern, int options,
+                                    const char ** help )
+        {
+            return (::pcre32_study(pattern, options, help));
+        }
+
+        static void free_study ( study_handle extra )
+        {
+            ::pcre32_free_study(extra);
+        }
+
+        static jit_stack allocate_jit_stack ( int start, int limit )
+        {
+            return (::pcre32_jit_stack_alloc(start, limit));
+        }
+
+        static void free_jit_stack ( jit_stack stack )
+        {
+            ::pcre32_jit_stack_free(stack);
+        }
+
+        static void assign_jit_stack ( study_handle extra,
+                                       jit_callback callback, void * data )
+        {
+            ::pcre32_assign_jit_stack(extra, callback, data);
+        }
+
+        static int query ( handle pattern, extra extra, int what, void * where )
+        {
+            return (::pcre32_fullinfo(pattern, extra, what, where));
+        }
+
+        static int string_number ( handle pattern, const_char_ptr name )
+        {
+            return (::pcre32_get_stringnumber(pattern, to(name)));
+        }
+
+        static int config ( int what, void * where )
+        {
+            return (::pcre32_config(what, where));
+        }
+
+        static void set_allocator ( void * (*allocate)(std::size_t),
+                                    void (*release)(void*) )
+        {
+            ::pcre32_malloc = allocate, ::pcre32_free = release;
+            ::pcre32_stack_malloc = allocate, ::pcre32_stack_free = release;
+        }
+
+        static int execute ( handle pattern, extra extra,
+                             const_char_ptr data, int size, int base,
+                             int options, int * results, int count )
+        {
+            return (::pcre32_exec(pattern, extra, to(data), size,
+                                  base, options, results, count));
+        }
+
+        static int dfa_execute ( handle pattern, extra extra,
+                                 const_char_ptr data, int size, int base,
+                                 int options, int * results, int count,
+                                 int * workspace, int workspace_size )
+        {
+            return (::pcre32_dfa_exec(pattern, extra, to(data), size,
+                                      base, options, results, count,
+                                      workspace, workspace_size));
+        }
+
+        static int next_char ( const_char_ptr, int, int offset )
+        {
+            // Every character is a single code unit.
+            return (offset+1);
+        }
+
+        static int char_start ( const_char_ptr, int, int offset )
+        {
+            return (offset);
+        }
+
+        static int max_char_size ()
+        {
+            return (1);
+        }
+
+        static int whole_chars ( const_char_ptr, int size )
+        {
+            return (size);
+        }
+
+        static int table_offset ()
+        {
+            return (1);
+        }
+
+        static int table_index ( const_char_ptr entry )
+        {
+            return (*to(entry));
+        }
+
+    protected:
+        static const_char_ptr from ( PCRE_SPTR32 pointer )
+        {
+            return (reinterpret_cast<const_char_ptr>(pointer));
+        }
+
+        static PCRE_SPTR32 to ( const_char_ptr pointer )
+        {
+            return (reinterpret_cast<PCRE_SPTR32>(pointer));
+        }
+    };
+
+    // Selects the library that matches the size of wchar_t.
+    template<std::size_t N> struct wide_traits;
+
+    template<> struct wide_traits<2>
+    {
+        typedef pcre16_traits<wchar_t> type;
+    };
+
+    template<> struct wide_traits<4>
+    {
+        typedef pcre32_traits<wchar_t> type;
+    };
+
+    template<> struct traits<char16_t> :
+        public pcre16_traits<char16_t>
+    {
+    };
+
+    template<> struct traits<char32_t> :
+        public pcre32_traits<char32_t>
+    {
+    };
+
+    /*!
+     * @brief Wide strings are UTF-16 where @c wchar_t has 16 bits (e.g.
+     *  Windows) and UTF-32 elsewhere (e.g. Linux).
+     */
+    template<> struct traits<wchar_t> :
+        public wide_traits<sizeof(wchar_t)>::type
+    {
+    };
+
 }
 
 #endif /* _pcrexx_traits_hpp__ */
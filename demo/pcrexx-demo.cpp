@@ -27,6 +27,60 @@
 #include "pcre.hpp"
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    typedef std::vector< std::pair<std::size_t,std::size_t> > positions;
+
+    // Records where matches start and end in the searched buffer.
+    struct recorder
+    {
+        positions * matches;
+
+        void operator() ( const pcrexx::match_view& match,
+                          std::size_t base ) const
+        {
+            const std::size_t start = base + match.group_base();
+            matches->push_back(
+                std::make_pair(start, start+match.group_size()));
+        }
+    };
+
+    // Check that searching in parallel finds the same matches as searching
+    // sequentially.  Small parts make many matches cross from one part to
+    // the next.
+    bool same_matches ( pcrexx::thread_pool& pool, const char * expression,
+                        const std::string& text,
+                        pcrexx::runtime_options options=
+                            pcrexx::runtime_options() )
+    {
+        const pcrexx::pattern pattern(expression);
+        positions sequential;
+        positions parallel;
+        const recorder lhs = { &sequential };
+        const recorder rhs = { &parallel };
+        pcrexx::search_buffer
+            (pattern, text.data(), text.size(), lhs, options);
+        pcrexx::parallel_search_buffer
+            (pool, pattern, text.data(), text.size(), rhs, options, 100);
+        return (!sequential.empty() && (sequential == parallel));
+    }
+
+    // Check that the prefilter doesn't skip a match of @a expression in
+    // @a text, e.g. because text after (*ACCEPT) was taken as required.
+    bool keeps_match ( const char * expression, const std::string& text )
+    {
+        const pcrexx::pattern pattern(expression);
+        positions matches;
+        const recorder record = { &matches };
+        pcrexx::search_buffer(pattern, text.data(), text.size(), record);
+        return (!matches.empty());
+    }
+
+}
 
 int main ( int, char ** )
 try
@@ -53,6 +107,118 @@ try
             << "No match!"
             << std::endl;
     }
+
+    // The bundled PCRE is built with JIT support, so requesting it must
+    // produce machine code rather than fall back to the interpreter.
+    const pcrexx::wpattern jitted(L"hello, (?<greetee>\\w+)!",
+                                  pcrexx::compile_options(),
+                                  pcrexx::study_options().jit());
+    if (!jitted.jit_compiled())
+    {
+        std::wcerr
+            << L"JIT compilation not available!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+    std::wcout
+        << L"JIT: enabled."
+        << std::endl;
+
+    // Each repetition of the group keeps backtracking data on the JIT
+    // stack, so this needs far more than PCRE's default 32K stack.
+    const char * deep = "^(a|b)*$";
+    const std::string subject(20000, 'a');
+    pcrexx::jit_stack_pool<char>::resize(32*1024, 4*1024*1024);
+
+    // Without our stacks, PCRE runs out of space.
+    typedef pcrexx::traits<char> traits;
+    int error = 0;
+    int offset = 0;
+    const char * help = 0;
+    traits::handle raw = traits::compile
+        (deep, 0, &error, &help, &offset, 0);
+    traits::study_handle extra = traits::study
+        (raw, PCRE_STUDY_JIT_COMPILE, &help);
+    int results[6];
+    const int status = traits::execute
+        (raw, extra, subject.data(), int(subject.size()), 0, 0, results, 6);
+    traits::free_study(extra);
+    traits::release(raw);
+    if (status != PCRE_ERROR_JIT_STACKLIMIT)
+    {
+        std::wcerr
+            << L"Expected the default JIT stack to overflow!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    // Patterns pick up the stack of the current thread, see "jit.hpp".
+    const pcrexx::pattern stacked(deep, pcrexx::compile_options(),
+                                  pcrexx::study_options().jit());
+    if (!stacked(subject.data(), int(subject.size()), results))
+    {
+        std::wcerr
+            << L"No match on the per-thread JIT stack!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+    std::wcout
+        << L"JIT stack: "
+        << pcrexx::jit_stack_pool<char>::maximum_size()
+        << L" bytes."
+        << std::endl;
+
+    // Matches may end at (*ACCEPT), so nothing after it is required.
+    if (!keeps_match("ab(*ACCEPT)xyz", "--ab--") ||
+        !keeps_match("a(b(?:c|(*ACCEPT)))xyz", "--ab--") ||
+        !keeps_match("took (\\d+) ms", "it took 12 ms"))
+    {
+        std::wcerr
+            << L"Prefilter skipped a match!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+    std::wcout
+        << L"Prefilter: OK."
+        << std::endl;
+
+    // "\A" only matches at the start of the stream, not at the start of
+    // each chunk.
+    const pcrexx::pattern start("\\Aab");
+    pcrexx::stream_matcher stream(start);
+    positions starts;
+    const recorder record = { &starts };
+    stream.feed("ab", 2, record);
+    stream.feed("xxab", 4, record);
+    stream.feed("ab", 2, record);
+    stream.finish(record);
+    if (starts.size() != 1)
+    {
+        std::wcerr
+            << L"Stream matched \\A mid-stream!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    std::string records;
+    for (int i=0; (i < 1000); ++i) {
+        records += "ab:123456789;";
+    }
+    pcrexx::thread_pool pool(4);
+    if (!same_matches(pool, "\\d+", records) ||
+        !same_matches(pool, "[a-z]+:\\d{3}|;", records) ||
+        !same_matches(pool, "\\G[a-z]+:\\d+;", records) ||
+        !same_matches(pool, "[a-z]+:\\d+;", records,
+                      pcrexx::runtime_options().anchored()))
+    {
+        std::wcerr
+            << L"Parallel search differs from sequential search!"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+    std::wcout
+        << L"Parallel search: OK."
+        << std::endl;
 }
 catch (const std::exception& error)
 {
@@ -37,8 +37,10 @@ if(NOT pcre_FOUND)
   set(PCRE_STATIC ON CACHE STRING "PCRE static")
   set(PCRE_BUILD_PCRE8 ON CACHE STRING "PCRE8")
   set(PCRE_BUILD_PCRE16 ON CACHE STRING "PCRE16")
+  set(PCRE_BUILD_PCRE32 ON CACHE STRING "PCRE32")
   set(PCRE_BUILD_PCRECPP OFF CACHE STRING "PCRECPP")
   set(PCRE_SUPPORT_UTF ON CACHE STRING "PCRE UTF support")
+  set(PCRE_SUPPORT_JIT ON CACHE STRING "PCRE JIT")
   add_subdirectory(
     ${pcre_DIR}/pcre
     ${CMAKE_CURRENT_BINARY_DIR}/pcre
@@ -59,12 +61,12 @@ if(NOT pcre_FOUND)
   # Export library targets.
   if (CMAKE_BUILD_TYPE STREQUAL "Debug")
     set(pcre_libraries
-      pcred pcre16d
+      pcred pcre16d pcre32d
       CACHE INTERNAL "PCRE library" FORCE
     )
   else()
     set(pcre_libraries
-      pcre pcre16
+      pcre pcre16 pcre32
       CACHE INTERNAL "PCRE library" FORCE
     )
   endif()